@@ -63,6 +63,16 @@ public:
 
     // Process keyboard input
     void ProcessKeyboard(GLFWwindow* window, float deltaTime)
+    {
+        ProcessMovement(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS,
+                        glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS,
+                        glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS,
+                        glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS,
+                        deltaTime);
+    }
+
+    // Walk with keys that were already read (live or from a replay)
+    void ProcessMovement(bool forward, bool backward, bool left, bool rightward, float deltaTime)
     {
         float velocity = movementSpeed * deltaTime;
 
@@ -71,13 +81,13 @@ public:
         horizontalFront.y = 0.0f;
         horizontalFront = glm::normalize(horizontalFront);
 
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        if (forward)
             position += horizontalFront * velocity;
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        if (backward)
             position -= horizontalFront * velocity;
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (left)
             position -= right * velocity;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (rightward)
             position += right * velocity;
     }
     
@@ -1,59 +1,178 @@
 #version 330 core
+// Compiled in variants (ShaderVariants), the #defines are inserted after the #version line:
+//   TEXTURED                                diffuse map, otherwise uDiffuseColor
+//   ALPHA_OPAQUE / ALPHA_TEST / ALPHA_BLEND alpha ignored / cut out below 0.1 / also times uOpacity
+//   LIGHT_POINT / LIGHT_DIRECTIONAL         light at uLightPos / light shining along uLightDir
+//   CLUSTERED_LIGHTS                        plus the small lights (bulbs, spots, glow) of this fragment's cluster
+//   SHADOWS                                 main light shadowed through uShadowMap
+//   WEIGHTED_OIT                            (with ALPHA_BLEND) writes weighted sums for WeightedOIT instead of a color
+#ifdef WEIGHTED_OIT
+layout (location = 0) out vec4 FragColor; // Weighted premultiplied color, alpha for the revealage
+layout (location = 1) out float FragWeight;
+#else
 out vec4 FragColor;
+#endif
 
-in vec3 chNormal;  
-in vec3 chFragPos;  
+in vec3 chNormal;
+in vec3 chFragPos;
 in vec2 chUV;
-  
-uniform vec3 uLightPos; 
-uniform vec3 uViewPos; 
+
+uniform vec3 uViewPos;
 uniform vec3 uLightColor;
-uniform int uLightType; // 0 = point, 1 = directional
 uniform vec3 uAmbientColor; // Separate ambient color
 
-uniform vec3 uDiffuseColor;  // Material color
-uniform int uHasTexture; 
-uniform float uOpacity;   
+#ifdef LIGHT_DIRECTIONAL
+uniform vec3 uLightDir;
+#else
+uniform vec3 uLightPos;
+#endif
 
+#ifdef TEXTURED
 uniform sampler2D uDiffMap1;
+#else
+uniform vec3 uDiffuseColor;  // Material color
+#endif
+
+#ifdef ALPHA_BLEND
+uniform float uOpacity;
+#endif
+
+#ifdef CLUSTERED_LIGHTS
+in float chViewDepth;
+
+uniform samplerBuffer uLightData;     // 3 texels per light: position + radius, color + spot cosine, spot direction
+uniform usamplerBuffer uClusterGrid;  // Per cluster: first entry in uLightIndices, light count
+uniform usamplerBuffer uLightIndices;
+uniform vec3 uClusterCount;           // Tiles across, tiles down, depth slices
+uniform vec2 uTileSize;               // In pixels
+uniform float uSliceScale;
+uniform float uSliceBias;
+
+// Diffuse + specular of the lights in this fragment's cluster
+vec3 ClusterLights(vec3 norm, vec3 viewDir)
+{
+    ivec3 count = ivec3(uClusterCount);
+    ivec2 tile = min(ivec2(gl_FragCoord.xy / uTileSize), count.xy - 1);
+    int slice = clamp(int(log(chViewDepth) * uSliceScale + uSliceBias), 0, count.z - 1);
+    uvec2 range = texelFetch(uClusterGrid, tile.x + count.x * (tile.y + count.y * slice)).xy;
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < range.y; i++)
+    {
+        int light = int(texelFetch(uLightIndices, int(range.x + i)).r) * 3;
+        vec4 positionRadius = texelFetch(uLightData, light);
+        vec4 colorSpot = texelFetch(uLightData, light + 1);
+
+        vec3 toLight = positionRadius.xyz - chFragPos;
+        float dist = length(toLight);
+        if (dist >= positionRadius.w)
+            continue;
+        vec3 lightDir = toLight / dist;
+
+        // Fades out to nothing at the radius
+        float attenuation = 1.0 - dist / positionRadius.w;
+        attenuation *= attenuation;
+
+        // Spotlight cone, soft edge
+        if (colorSpot.w > -1.0)
+        {
+            vec3 spotDir = texelFetch(uLightData, light + 2).xyz;
+            attenuation *= smoothstep(colorSpot.w, mix(colorSpot.w, 1.0, 0.2), dot(-lightDir, spotDir));
+        }
+
+        float diff = max(dot(norm, lightDir), 0.0);
+        float spec = pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), 32);
+        result += (diff + 0.5 * spec) * attenuation * colorSpot.rgb;
+    }
+    return result;
+}
+#endif
+
+#ifdef SHADOWS
+in vec4 chLightSpacePos;
+
+uniform sampler2DShadow uShadowMap;
+
+// 1 lit, 0 in shadow. 3x3 taps, each one already a bilinear 2x2 compare.
+float ShadowFactor(float bias)
+{
+    vec3 coords = chLightSpacePos.xyz / chLightSpacePos.w * 0.5 + 0.5;
+    if (chLightSpacePos.w <= 0.0 || coords.z > 1.0)
+        return 1.0; // Behind the light or past its far plane
+    coords.z -= bias;
+
+    vec2 texel = 1.0 / vec2(textureSize(uShadowMap, 0));
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(uShadowMap, vec3(coords.xy + vec2(x, y) * texel, coords.z));
+    return lit / 9.0;
+}
+#endif
 
 void main()
-{    
+{
     // Get base color with alpha
-    vec4 baseColor;
-    if(uHasTexture == 1) {
-        baseColor = texture(uDiffMap1, chUV);
-    } else {
-        baseColor = vec4(uDiffuseColor, 1.0);
-    }
-    
+#ifdef TEXTURED
+    vec4 baseColor = texture(uDiffMap1, chUV);
+#else
+    vec4 baseColor = vec4(uDiffuseColor, 1.0);
+#endif
+
+#ifdef ALPHA_BLEND
     // Apply material opacity
     baseColor.a *= uOpacity;
-    
+#endif
+
+#if defined(ALPHA_TEST) || defined(ALPHA_BLEND)
     // Discard fully transparent pixels
     if(baseColor.a < 0.1)
         discard;
+#else
+    baseColor.a = 1.0;
+#endif
 
     // AMBIENT - completely separate, always use uAmbientColor
     float ambientStrength = 0.8; // Much higher for good visibility
     vec3 ambient = ambientStrength * uAmbientColor;
-    
-    // POINT LIGHT from top - not directional
+
     vec3 norm = normalize(chNormal);
-    vec3 lightPos = vec3(0.0, 5.0, 0.0); // Fixed position at top
-    vec3 lightDir = normalize(lightPos - chFragPos); // Calculate direction from top to fragment
-    
+#ifdef LIGHT_DIRECTIONAL
+    vec3 lightDir = normalize(-uLightDir);
+#else
+    vec3 lightDir = normalize(uLightPos - chFragPos); // From the fragment towards the light
+#endif
+
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = diff * uLightColor * 0.5; // Reduce intensity by half
-    
-    // SPECULAR from directional light only
+
+    // SPECULAR
     float specularStrength = 0.5;
     vec3 viewDir = normalize(uViewPos - chFragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);  
+    vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-    vec3 specular = specularStrength * spec * uLightColor;  
+    vec3 specular = specularStrength * spec * uLightColor;
+
+#ifdef SHADOWS
+    // Steeper surfaces need more bias
+    float shadow = ShadowFactor(max(0.002 * (1.0 - dot(norm, lightDir)), 0.0005));
+    diffuse *= shadow;
+    specular *= shadow;
+#endif
 
-    // Combine: ambient (always white) + directional light (colored)
-    vec3 result = (ambient + diffuse + specular) * baseColor.rgb;
+    // Combine: ambient (always white) + light (colored)
+    vec3 lighting = ambient + diffuse + specular;
+#ifdef CLUSTERED_LIGHTS
+    lighting += ClusterLights(norm, viewDir);
+#endif
+    vec3 result = lighting * baseColor.rgb;
+#ifdef WEIGHTED_OIT
+    // Weight falls off with depth so the nearer layers win (McGuire & Bavoil, eq. 10)
+    float a = baseColor.a;
+    float weight = clamp(pow(min(1.0, a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+    FragColor = vec4(result * a * weight, a);
+    FragWeight = a * weight;
+#else
     FragColor = vec4(result, baseColor.a);
+#endif
 }
@@ -6,16 +6,31 @@ layout (location = 2) in vec2 inUV;
 out vec3 chFragPos;
 out vec3 chNormal;
 out vec2 chUV;
+#ifdef CLUSTERED_LIGHTS
+out float chViewDepth; // Distance in front of the camera, picks the cluster's depth slice
+#endif
+#ifdef SHADOWS
+out vec4 chLightSpacePos;
+uniform mat4 uLightSpace; // Shadow map's projection * view
+#endif
 
 uniform mat4 uM;
 uniform mat4 uV;
 uniform mat4 uP;
 
+invariant gl_Position; // Same depth as depth.vert, for the GL_EQUAL test after the pre-pass
+
 void main()
 {
     chUV = inUV;
     chFragPos = vec3(uM * vec4(inPos, 1.0));
     chNormal = mat3(transpose(inverse(uM))) * inNormal;  
+#ifdef CLUSTERED_LIGHTS
+    chViewDepth = -(uV * vec4(chFragPos, 1.0)).z;
+#endif
+#ifdef SHADOWS
+    chLightSpacePos = uLightSpace * vec4(chFragPos, 1.0);
+#endif
     
     gl_Position = uP * uV * vec4(chFragPos, 1.0);
 }
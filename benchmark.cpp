@@ -0,0 +1,399 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Benchmark: builds the real claw machine scene at several prize counts, plays the same scripted claw
+// sessions on each and reports step/frame times, draw calls and memory as JSON.
+//
+//   Benchmark [--prizes 10,100,1000,10000] [--sessions 5] [--variant all|headless|render|render_prepass|render_occlusion]
+//             [--out benchmark.json]
+//
+// The headless variant only runs the simulation (no window, no GL), so it works on machines without a display.
+// render_prepass draws like render but with the depth pre-pass in front, to compare the two, and render_occlusion
+// adds occlusion culling of the prizes on top of the pre-pass.
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <reactphysics3d/reactphysics3d.h>
+#include "claw_game.hpp"
+#include "occlusion_culler.hpp"
+#include "scene_renderer.hpp"
+#include "shader.hpp"
+#include "shader_variants.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+typedef std::chrono::steady_clock BenchClock;
+
+const double stepTime = 1.0 / 60.0;
+const int sessionSteps = 360; // One scripted claw session, 6 seconds of game time
+
+rp3d::PhysicsCommon physicsCommon;
+
+struct Stats {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+struct BenchmarkResult {
+    std::string variant;
+    int prizes = 0;
+    int steps = 0;
+    double setupMs = 0.0;
+    Stats stepMs;
+    Stats frameMs;          // Render variant only: step + gather + draw + swap
+    double drawCalls = 0.0; // Per frame, one per mesh drawn
+    double memoryMb = 0.0;  // Resident set at the end of the run
+    double peakMemoryMb = 0.0;
+};
+
+double ElapsedMs(BenchClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+Stats ComputeStats(std::vector<double> samples)
+{
+    Stats stats;
+    if (samples.empty()) return stats;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+
+    auto percentile = [&samples](double p) {
+        size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[index];
+    };
+
+    stats.mean = sum / samples.size();
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+// Current and peak resident memory in MB
+void GetMemoryUsage(double& current, double& peak)
+{
+    current = 0.0;
+    peak = 0.0;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        current = counters.WorkingSetSize / (1024.0 * 1024.0);
+        peak = counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+    }
+#else
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        // Values are in kB
+        if (line.compare(0, 6, "VmRSS:") == 0) current = std::atof(line.c_str() + 6) / 1024.0;
+        if (line.compare(0, 6, "VmHWM:") == 0) peak = std::atof(line.c_str() + 6) / 1024.0;
+    }
+#endif
+}
+
+// The same input every run: start a game, steer the claw around for a bit, drop it, wait for it to come
+// back up, then drop again (lets go of the birb if it caught one). Each session steers differently.
+ClawCommand ScriptedCommand(int step)
+{
+    int session = step / sessionSteps;
+    int t = step % sessionSteps;
+
+    ClawCommand command = {};
+    command.cameraPosition = glm::vec3(0.0f, 0.0f, 5.0f); // Out of reach of the pile, no direct pickups
+
+    if (t == 0) {
+        command.interact = true;
+        command.lookingAtMachine = true;
+    }
+    else if (t < 120) {
+        float angle = 0.05f * t + 1.3f * session;
+        command.move = glm::vec2(std::cos(angle), std::sin(angle));
+    }
+    else if (t == 120 || t == 300) {
+        command.drop = true;
+    }
+    return command;
+}
+
+std::string ToJson(const Stats& stats)
+{
+    std::ostringstream out;
+    out << "{\"mean\": " << stats.mean << ", \"p50\": " << stats.p50 << ", \"p95\": " << stats.p95
+        << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << "}";
+    return out.str();
+}
+
+std::string ToJson(const BenchmarkResult& result)
+{
+    std::ostringstream out;
+    out << "{\"variant\": \"" << result.variant << "\", \"prizes\": " << result.prizes
+        << ", \"steps\": " << result.steps << ", \"setup_ms\": " << result.setupMs
+        << ", \"step_ms\": " << ToJson(result.stepMs);
+    if (result.variant != "headless") {
+        out << ", \"frame_ms\": " << ToJson(result.frameMs) << ", \"draw_calls\": " << result.drawCalls;
+    }
+    out << ", \"memory_mb\": " << result.memoryMb << ", \"peak_memory_mb\": " << result.peakMemoryMb << "}";
+    return out.str();
+}
+
+ClawGameSettings MakeSettings(int prizes)
+{
+    ClawGameSettings settings;
+    settings.prizeCount = prizes;
+    // One cache per count, so the game's own pile and the other counts aren't resimulated every run
+    settings.pileCachePath = "res/bench_pile_" + std::to_string(prizes) + ".bin";
+    // Stress test: the whole count, even when it's far more than the cabinet holds
+    settings.clampPileToMachine = false;
+    return settings;
+}
+
+BenchmarkResult RunHeadless(int prizes, int steps)
+{
+    BenchmarkResult result;
+    result.variant = "headless";
+    result.prizes = prizes;
+    result.steps = steps;
+
+    BenchClock::time_point setupStart = BenchClock::now();
+    ClawGame game(physicsCommon, MakeSettings(prizes));
+    result.prizes = static_cast<int>(game.GetBirbs().size()); // All of them unless the pile was capped
+    result.setupMs = ElapsedMs(setupStart);
+
+    std::vector<double> stepSamples;
+    stepSamples.reserve(steps);
+    for (int step = 0; step < steps; step++) {
+        ClawCommand command = ScriptedCommand(step);
+        BenchClock::time_point start = BenchClock::now();
+        game.Step(command, stepTime);
+        stepSamples.push_back(ElapsedMs(start));
+    }
+
+    result.stepMs = ComputeStats(stepSamples);
+    GetMemoryUsage(result.memoryMb, result.peakMemoryMb);
+    return result;
+}
+
+// One step per frame, drawn the same way the game draws a FrameSnapshot, as fast as it goes (no vsync).
+// With a depthShader the depth pre-pass runs first (its draw calls are counted too), with an occlusionCuller
+// as well covered prizes are skipped.
+BenchmarkResult RunRender(GLFWwindow* window, ShaderVariants& shader, Shader* depthShader, OcclusionCuller* occlusionCuller,
+                          int prizes, int steps)
+{
+    BenchmarkResult result;
+    result.variant = occlusionCuller ? "render_occlusion" : depthShader ? "render_prepass" : "render";
+    result.prizes = prizes;
+    result.steps = steps;
+
+    BenchClock::time_point setupStart = BenchClock::now();
+    ClawGame game(physicsCommon, MakeSettings(prizes));
+    result.prizes = static_cast<int>(game.GetBirbs().size()); // All of them unless the pile was capped
+    SceneRenderer renderer;
+    renderer.LoadModels(game.GetScene(), shader);
+    result.setupMs = ElapsedMs(setupStart);
+
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(window, &width, &height);
+
+    shader.setVec3("uLightPos", 0.0f, 5.0f, 0.0f);
+    shader.setVec3("uViewPos", 0.0f, 1.0f, 4.0f);
+    shader.setVec3("uLightColor", 1.0f, 0.2f, 0.6f);
+    shader.setVec3("uAmbientColor", 1.0f, 1.0f, 1.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 1.0f, 4.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)std::max(height, 1), 0.1f, 100.0f);
+    shader.setMat4("uV", view);
+    shader.setMat4("uP", projection);
+    if (depthShader) {
+        depthShader->use();
+        depthShader->setMat4("uV", view);
+        depthShader->setMat4("uP", projection);
+    }
+
+    std::vector<double> stepSamples;
+    std::vector<double> frameSamples;
+    std::vector<DrawItem> items;
+    std::vector<DrawItem> visibleItems;
+    stepSamples.reserve(steps);
+    frameSamples.reserve(steps);
+    double totalDrawCalls = 0.0;
+
+    for (int step = 0; step < steps && !glfwWindowShouldClose(window); step++) {
+        BenchClock::time_point frameStart = BenchClock::now();
+
+        ClawCommand command = ScriptedCommand(step);
+        BenchClock::time_point stepStart = BenchClock::now();
+        game.Step(command, stepTime);
+        stepSamples.push_back(ElapsedMs(stepStart));
+
+        items.clear();
+        TransformSystem::Update(game.GetScene());
+        RenderSystem::Gather(game.GetScene(), items);
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        const std::vector<DrawItem>* drawn = &items;
+        if (occlusionCuller) {
+            occlusionCuller->Filter(items, visibleItems);
+            drawn = &visibleItems;
+        }
+        if (depthShader) {
+            totalDrawCalls += renderer.DrawDepth(*depthShader, *drawn, false);
+            if (occlusionCuller) {
+                occlusionCuller->IssueQueries(*depthShader, renderer, items, glm::vec3(0.0f, 1.0f, 4.0f));
+            }
+        }
+        totalDrawCalls += renderer.Draw(shader, *drawn, false, depthShader != nullptr);
+        totalDrawCalls += renderer.DrawTransparent(shader, *drawn, glm::vec3(0.0f, 1.0f, 4.0f), false);
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+        glFinish(); // Count the GPU's time too, not just submitting
+        frameSamples.push_back(ElapsedMs(frameStart));
+    }
+
+    result.steps = static_cast<int>(frameSamples.size());
+    result.stepMs = ComputeStats(stepSamples);
+    result.frameMs = ComputeStats(frameSamples);
+    result.drawCalls = frameSamples.empty() ? 0.0 : totalDrawCalls / frameSamples.size();
+    GetMemoryUsage(result.memoryMb, result.peakMemoryMb);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<int> prizeCounts = { 10, 100, 1000, 10000 };
+    int sessions = 5;
+    std::string variant = "all";
+    std::string outPath = "benchmark.json";
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--prizes")
+        {
+            prizeCounts.clear();
+            std::stringstream list(argv[i + 1]);
+            std::string count;
+            while (std::getline(list, count, ',')) {
+                prizeCounts.push_back(std::max(0, std::atoi(count.c_str())));
+            }
+        }
+        else if (arg == "--sessions")
+        {
+            sessions = std::max(1, std::atoi(argv[i + 1]));
+        }
+        else if (arg == "--variant")
+        {
+            variant = argv[i + 1];
+        }
+        else if (arg == "--out")
+        {
+            outPath = argv[i + 1];
+        }
+    }
+
+    int steps = sessions * sessionSteps;
+    std::vector<BenchmarkResult> results;
+
+    if (variant == "all" || variant == "headless")
+    {
+        for (int prizes : prizeCounts) {
+            std::cout << "--- headless, " << prizes << " prizes ---" << std::endl;
+            results.push_back(RunHeadless(prizes, steps));
+        }
+    }
+
+    bool render = variant == "all" || variant == "render";
+    bool renderPrepass = variant == "all" || variant == "render_prepass";
+    bool renderOcclusion = variant == "all" || variant == "render_occlusion";
+    if (render || renderPrepass || renderOcclusion)
+    {
+        GLFWwindow* window = nullptr;
+        if (glfwInit())
+        {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+            window = glfwCreateWindow(1280, 720, "Claw Machine Benchmark", NULL, NULL);
+        }
+
+        if (window == NULL)
+        {
+            std::cout << "No window, skipping the render variant" << std::endl;
+        }
+        else
+        {
+            glfwMakeContextCurrent(window);
+            glfwSwapInterval(0);
+
+            if (glewInit() != GLEW_OK)
+            {
+                std::cout << "GLEW fail! :(\n" << std::endl;
+            }
+            else
+            {
+                glEnable(GL_DEPTH_TEST);
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+                ShaderVariants shader("basic.vert", "basic.frag");
+                Shader depthShader("depth.vert", "depth.frag");
+                for (int prizes : prizeCounts) {
+                    if (render) {
+                        std::cout << "--- render, " << prizes << " prizes ---" << std::endl;
+                        results.push_back(RunRender(window, shader, nullptr, nullptr, prizes, steps));
+                    }
+                    if (renderPrepass) {
+                        std::cout << "--- render_prepass, " << prizes << " prizes ---" << std::endl;
+                        results.push_back(RunRender(window, shader, &depthShader, nullptr, prizes, steps));
+                    }
+                    if (renderOcclusion) {
+                        // Fresh per run, query state is keyed by entity
+                        OcclusionCuller occlusionCuller;
+                        std::cout << "--- render_occlusion, " << prizes << " prizes ---" << std::endl;
+                        results.push_back(RunRender(window, shader, &depthShader, &occlusionCuller, prizes, steps));
+                    }
+                }
+            }
+        }
+        glfwTerminate();
+    }
+
+    std::ofstream out(outPath);
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "  " << ToJson(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+
+    std::cout << std::endl << "Results (" << outPath << "):" << std::endl;
+    for (const BenchmarkResult& result : results) {
+        std::cout << ToJson(result) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,481 @@
+#ifndef CLAW_GAME_HPP
+#define CLAW_GAME_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <reactphysics3d/reactphysics3d.h>
+#include "gameobject.hpp"
+#include "log.hpp"
+#include "mesh_data.hpp"
+#include "physics_events.hpp"
+#include "prize_spawner.hpp"
+
+#include <string>
+#include <vector>
+
+#define GROUND_HEIGHT 0.2f
+
+// Player input for one simulation step
+struct ClawCommand {
+    glm::vec2 move;          // Claw movement (x, z), -1..1 per axis
+    bool interact;           // E pressed this frame
+    bool lookingAtMachine;   // Camera was facing the claw machine when E was pressed
+    bool drop;               // Space pressed this frame
+    glm::vec3 cameraPosition;
+};
+
+struct ClawGameSettings {
+    int prizeCount = 20;
+
+    // Where the settled prize pile is cached
+    std::string pileCachePath = "res/prize_pile.bin";
+
+    // Cap the pile at what the cabinet holds (about 100 birbs). Off for stress runs, see PrizeSpawnSettings.
+    bool clampPileToMachine = true;
+
+    // Print game events (started, picked up, ...). Off for mass simulation.
+    bool logEvents = true;
+};
+
+// One claw machine: its physics world, the scene and the game rules (claw movement, pickup, drop,
+// collecting). No GL or GLFW in here, so it runs the same with or without a window: input comes in as
+// ClawCommands, the renderer only reads the scene (model ids + transforms) and the getters below.
+class ClawGame {
+public:
+    ClawGame(rp3d::PhysicsCommon& physicsCommon, const ClawGameSettings& settings)
+        : physicsCommon(physicsCommon), settings(settings) {
+        rp3d::PhysicsWorld::WorldSettings worldSettings;
+        worldSettings.gravity = rp3d::Vector3(0.0f, -9.81f, 0.0f);
+        // Extra solver iterations keep tall prize piles from jittering and sinking into each other
+        worldSettings.defaultVelocitySolverNbIterations = 15;
+        worldSettings.defaultPositionSolverNbIterations = 8;
+        physicsWorld = physicsCommon.createPhysicsWorld(worldSettings);
+        physicsWorld->setEventListener(&physicsEvents);
+
+        gameObjects = new GameObjectManager(settings.prizeCount + 16); // Prizes plus the machine, claw, etc.
+        prizeSpawner = new PrizeSpawner(*gameObjects, physicsCommon, physicsWorld);
+
+        InitializeGameObjects();
+    }
+
+    ~ClawGame() {
+        // Objects remove their bodies from the world, so they go before it
+        birbs.clear();
+        delete gameObjects;
+        delete prizeSpawner;
+        physicsCommon.destroyPhysicsWorld(physicsWorld);
+    }
+
+    ClawGame(const ClawGame&) = delete;
+    ClawGame& operator=(const ClawGame&) = delete;
+
+    // Advances the game by one fixed step: applies the input, moves the claw, steps the physics world
+    void Step(const ClawCommand& command, double deltaTime) {
+        // Check for E key to start game when looking at claw machine
+        if (!gameStarted && command.interact)
+        {
+            // Check for direct birb pickup first
+            GameObject* directPickupBirb = CanDirectPickupBirb(command.cameraPosition);
+            if (directPickupBirb) {
+                // Pick up birb directly
+                pickedUpBirb = directPickupBirb;
+                pickedUpBirb->GetRigidBody()->setType(rp3d::BodyType::KINEMATIC);
+                SetBirbState(directPickupBirb, PrizeState::Collected);
+                birbsCollected++;
+
+                if (settings.logEvents) Log::Info("Birb picked up directly! Total collected: ", birbsCollected);
+            }
+            else if (command.lookingAtMachine) {
+                gameStarted = true;
+                gamesPlayed++;
+                if (settings.logEvents) Log::Info("Game Started!");
+            }
+        }
+
+        MoveClaw(command.move, deltaTime);
+
+        // The trigger events of the last physics update came in while the claw was on its way down,
+        // the step it touched down included
+        bool wasDescending = descendedThisStep;
+        descendedThisStep = false;
+
+        // Handle Space key for claw movement
+        if (gameStarted && command.drop && !shouldMoveDown && !shouldMoveUp)
+        {
+            if (pickedUpBirb) {
+                // Birb's current world position, before it's detached from the claw
+                glm::vec3 dropPosition = glm::vec3(pickedUpBirb->GetWorldTransform()[3]);
+                dropPosition.y -= 0.2f;
+
+                // Drop the birb
+                claw->RemoveChild(pickedUpBirb);
+                SetBirbState(pickedUpBirb, PrizeState::Active);
+
+                // Re-enable dynamic physics so it falls
+                pickedUpBirb->GetRigidBody()->setType(rp3d::BodyType::DYNAMIC);
+
+                // Reset birb's transform components to world position
+                pickedUpBirb->SetTRS(dropPosition, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.4f, 0.4f, 0.4f));
+
+                pickedUpBirb = nullptr;
+
+                // End game
+                gameStarted = false;
+                if (settings.logEvents) Log::Info("Birb dropped! Game ended.");
+            } else {
+                // Normal claw descent
+                shouldMoveDown = true;
+                canMoveByKeys = false;
+                originalPosition = claw->GetPosition();
+            }
+        }
+
+        // Handle claw vertical movement
+        bool touchedDown = false;
+        if (shouldMoveDown)
+        {
+            descendedThisStep = true;
+            const float descentSpeed = 2.0f;
+            glm::vec3 movement(0.0f, -descentSpeed * static_cast<float>(deltaTime), 0.0f);
+
+            // Stops right on the claw machine or ground if they're in the way
+            SweepHit hit = claw->SweepTranslate(movement, { claw_machine, ground }, false);
+
+            // Update birb physics if it's being carried
+            if (pickedUpBirb) {
+                UpdateBirbPhysics();
+            }
+
+            if (hit.hit)
+            {
+                // Touched down, start moving up from the next step so the trigger reports what's down here
+                shouldMoveDown = false;
+                shouldMoveUp = true;
+                touchedDown = true;
+            }
+        }
+
+        if (shouldMoveUp && !touchedDown)
+        {
+            const float ascentSpeed = 3.0f;
+            glm::vec3 currentPos = claw->GetPosition();
+            glm::vec3 direction = glm::normalize(originalPosition - currentPos);
+            float distance = glm::distance(currentPos, originalPosition);
+
+            if (distance > 0.1f)
+            {
+                glm::vec3 movement = direction * ascentSpeed * static_cast<float>(deltaTime);
+                if (glm::length(movement) > distance)
+                {
+                    movement = direction * distance;
+                }
+                claw->Translate(movement);
+
+                // Update birb physics if it's being carried
+                if (pickedUpBirb) {
+                    UpdateBirbPhysics();
+                }
+            }
+            else
+            {
+                // Reached original position
+                claw->SetTRS(originalPosition, claw->GetRotation(), glm::vec3(0.4f, 0.4f, 0.4f));
+
+                // Update birb one last time at final position
+                if (pickedUpBirb) {
+                    UpdateBirbPhysics();
+                }
+
+                shouldMoveUp = false;
+                canMoveByKeys = true;
+
+                // End game if birb was not picked up after one cycle
+                if (!pickedUpBirb) {
+                    gameStarted = false;
+                    if (settings.logEvents) Log::Info("Game ended - birb not picked up");
+                }
+            }
+        }
+
+        // Pick up the birb reported by the claw trigger during the last physics step, only if the claw was
+        // on its way down in a game (not a birb that drifted into it while idle)
+        GameObject* collidedBirb = triggeredBirb;
+        if (collidedBirb && !pickedUpBirb && gameStarted && wasDescending) {
+            triggeredBirb = nullptr;
+
+            // Reset birb scale to original
+            collidedBirb->Scale(glm::vec3(1.0f, 1.0f, 1.0f));
+
+            claw->AddChild(collidedBirb);
+            SetBirbState(collidedBirb, PrizeState::Carried);
+
+            // Make birb kinematic so physics doesn't interfere while carried
+            collidedBirb->GetRigidBody()->setType(rp3d::BodyType::KINEMATIC);
+
+            pickedUpBirb = collidedBirb;
+            clawPickups++;
+            if (settings.logEvents) Log::Info("Birb picked up!");
+        }
+
+        // Update birb physics to follow claw while picked up (for horizontal movement)
+        if (pickedUpBirb && canMoveByKeys) {
+            UpdateBirbPhysics();
+        }
+
+        // Keep the trigger volume on the claw so the next step reports what it touches
+        trigger->SetPosition(claw->GetPosition());
+
+        // Update physics simulation (dispatches trigger/contact events)
+        physicsWorld->update(static_cast<rp3d::decimal>(deltaTime));
+
+        // Copy poses of the birbs still in the pile back into their transforms, sleeping ones are skipped
+        Scene& scene = gameObjects->GetScene();
+        transformsSynced = PhysicsSyncSystem::Update(scene, scene.PrizesIn(PrizeState::Active));
+    }
+
+    // ---------------- Read-only state for rendering, UI and benchmarks ----------------
+
+    bool IsGameStarted() const { return gameStarted; }
+    int GetBirbsCollected() const { return birbsCollected; }
+    int GetGamesPlayed() const { return gamesPlayed; }
+    int GetClawPickups() const { return clawPickups; } // Birbs the claw grabbed, over all games
+    bool IsCarryingBirb() const { return pickedUpBirb != nullptr; }
+    int GetTransformsSynced() const { return transformsSynced; } // Profiling: birbs updated from physics in the last step
+    bool IsClawMoving() const { return shouldMoveDown || shouldMoveUp; }
+
+    glm::vec3 GetMachinePosition() const { return machinePosition; } // Never moves
+    uint64_t GetPileHash() const { return prizeSpawner->GetPileHash(); } // Same hash, same starting pile
+    bool IsPileRestored() const { return prizeSpawner->WasRestored(); } // From the cache, not settled this launch
+    const Scene& GetScene() const { return gameObjects->GetScene(); }
+
+    // Mutable access for tools and snapshots (TransformSystem::Update), not for the renderer
+    Scene& GetScene() { return gameObjects->GetScene(); }
+    rp3d::PhysicsWorld* GetPhysicsWorld() { return physicsWorld; }
+    GameObject* GetClawMachine() { return claw_machine; }
+    GameObject* GetClaw() { return claw; }
+    const std::vector<GameObject*>& GetBirbs() const { return birbs; }
+
+private:
+    rp3d::PhysicsCommon& physicsCommon;
+    ClawGameSettings settings;
+
+    // Physics objects
+    rp3d::PhysicsWorld* physicsWorld = nullptr;
+    PhysicsEventListener physicsEvents;
+    PrizeSpawner* prizeSpawner = nullptr;
+
+    // Owns every GameObject in the scene
+    GameObjectManager* gameObjects = nullptr;
+
+    GameObject* claw = nullptr;
+    GameObject* claw_machine = nullptr;
+    GameObject* ground = nullptr;
+    GameObject* trigger = nullptr;
+    GameObject* lightCube = nullptr;
+
+    std::vector<GameObject*> birbs; // Active/carried/collected state is kept by the Scene
+    glm::vec3 machinePosition = glm::vec3(0.0f);
+
+    // Game state
+    bool gameStarted = false;
+
+    // Claw movement state
+    bool shouldMoveDown = false;
+    bool descendedThisStep = false; // The claw moved down (or touched down) in the current/last step
+    bool shouldMoveUp = false;
+    glm::vec3 originalPosition = glm::vec3(0.0f);
+    bool canMoveByKeys = true;
+    GameObject* pickedUpBirb = nullptr; // Track which birb is picked up
+    GameObject* triggeredBirb = nullptr; // Birb currently inside the claw's trigger volume
+    int birbsCollected = 0; // Track how many birbs collected
+    int gamesPlayed = 0;
+    int clawPickups = 0;
+    int transformsSynced = 0;
+
+    void InitializeGameObjects() {
+        // ==================== CLAW MACHINE ====================
+        claw_machine = gameObjects->Create("res/claw_machine.obj", physicsWorld, rp3d::BodyType::STATIC);
+        claw_machine->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
+        claw_machine->Translate(glm::vec3(0.0f, GROUND_HEIGHT, 0.0f));
+        claw_machine->SetTwoSided(true); // Culling would hide the inside walls
+        claw_machine->SetStatic(true);
+        machinePosition = claw_machine->GetPosition();
+
+        // Only the triangles, the renderer loads the full model
+        MeshData machineMesh;
+        if (LoadMeshData("res/claw_machine.obj", machineMesh)) {
+            claw_machine->AddConcaveCollision(physicsCommon, machineMesh);
+        }
+
+        // ==================== GROUND ====================
+        ground = gameObjects->Create("res/ground.obj", physicsWorld, rp3d::BodyType::STATIC);
+        ground->Translate(glm::vec3(0.0f, -2.0f, 0.0f));
+        ground->SetStatic(true);
+        ground->AddBoxCollision(physicsCommon, glm::vec3(10.0f, 0.5f, 10.0f));
+
+        // ==================== CLAW ====================
+        claw = gameObjects->Create("res/claw.obj", physicsWorld, rp3d::BodyType::KINEMATIC);
+        claw->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
+        claw->Translate(glm::vec3(0.0f, 1.0f, 0.0f));
+        claw->AddBoxCollision(physicsCommon, glm::vec3(0.1f, 0.3f, 0.1f));
+
+        // ==================== TRIGGER ====================
+        trigger = gameObjects->Create("res/trigger.obj", physicsWorld, rp3d::BodyType::KINEMATIC);
+        trigger->AddSphereCollision(physicsCommon, 0.2f);
+        trigger->SetIsTrigger(true);
+        trigger->SetPosition(claw->GetPosition()); // On the claw from the start, not in the pile being settled
+        trigger->onTrigger = [this](GameObject* other, PhysicsEvent event) { OnClawTrigger(other, event); };
+        trigger->SetVisible(false);
+
+        // ==================== BIRBS (Prize pile) ====================
+        // Dropped into the machine and settled once, later launches restore the cached pile
+        PrizeSpawnSettings prizeSettings;
+        prizeSettings.count = settings.prizeCount;
+        prizeSettings.cachePath = settings.pileCachePath;
+        // Fills the cabinet's floor up to just under the claw's resting height
+        prizeSettings.machine = &machineMesh;
+        prizeSettings.machineTransform = claw_machine->GetWorldTransform();
+        prizeSettings.areaMax.y = claw->GetPosition().y - 0.3f;
+        prizeSettings.clampToMachine = settings.clampPileToMachine;
+        prizeSettings.mix.push_back({ "res/birb.obj", glm::vec3(0.4f, 0.4f, 0.4f), glm::vec3(0.12f, 0.12f, 0.12f), 1.0f });
+        birbs = prizeSpawner->Spawn(prizeSettings);
+        triggeredBirb = nullptr; // Whatever touched the trigger while the pile settled doesn't count
+
+        // Every prize glows a little (hidden ones don't, see LightSystem)
+        LightComponent glow;
+        glow.color = glm::vec3(1.0f, 0.8f, 0.4f);
+        glow.intensity = 0.4f;
+        glow.radius = 0.3f;
+        for (GameObject* birb : birbs) {
+            birb->SetLight(glow);
+        }
+
+        // ==================== LIGHT CUBE ====================
+        lightCube = gameObjects->Create("res/trigger.obj", physicsWorld, rp3d::BodyType::STATIC);
+        lightCube->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
+        lightCube->Translate(glm::vec3(2.0f, 1.0f, 0.0f));
+        lightCube->SetStatic(true);
+        LightComponent lamp;
+        lamp.intensity = 0.7f;
+        lamp.radius = 3.0f;
+        lightCube->SetLight(lamp);
+
+        // ==================== MACHINE LIGHTS ====================
+        // Marquee bulbs around the top edge of the cabinet, alternating colors
+        const glm::vec3 bulbColors[] = { glm::vec3(1.0f, 0.85f, 0.3f), glm::vec3(1.0f, 0.3f, 0.6f), glm::vec3(0.3f, 0.8f, 1.0f) };
+        const int bulbsPerSide = 4;
+        int bulb = 0;
+        for (int side = 0; side < 4; side++) {
+            for (int i = 0; i < bulbsPerSide; i++) {
+                float along = -1.5f + 3.0f * i / (bulbsPerSide - 1);
+                float edge = (side % 2 == 0) ? 2.05f : -2.05f;
+                glm::vec3 position = side < 2 ? glm::vec3(along, 3.8f, edge) : glm::vec3(edge, 3.8f, along);
+
+                LightComponent light;
+                light.color = bulbColors[bulb++ % 3];
+                light.intensity = 0.6f;
+                light.radius = 0.8f;
+                AddMachineLight(position, light);
+            }
+        }
+
+        // Spotlights in the ceiling of the cabinet, shining down on the pile
+        for (int i = 0; i < 2; i++) {
+            LightComponent spot;
+            spot.intensity = 0.8f;
+            spot.radius = 3.5f;
+            spot.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+            spot.spotCosine = 0.866f; // 30 degrees
+            AddMachineLight(glm::vec3(i == 0 ? -1.0f : 1.0f, 3.5f, 0.0f), spot);
+        }
+    }
+
+    // A light of its own (no model or body), placed in the claw machine's model space
+    void AddMachineLight(const glm::vec3& position, const LightComponent& light) {
+        Scene& scene = gameObjects->GetScene();
+        Entity entity = scene.CreateEntity();
+        TransformComponent& transform = scene.transforms.Add(entity);
+        transform.position = position;
+        transform.parent = claw_machine->GetEntity();
+        scene.lights.Add(entity, light);
+    }
+
+    void MoveClaw(glm::vec2 input, double deltaTime) {
+        if (!gameStarted || !canMoveByKeys) return;
+
+        const float clawSpeed = 3.0f;
+        float dt = static_cast<float>(deltaTime);
+
+        glm::vec3 movement(input.x * clawSpeed * dt, 0.0f, input.y * clawSpeed * dt);
+
+        // Slides along the machine's walls instead of stopping dead
+        claw->SweepTranslate(movement, { claw_machine });
+    }
+
+    void OnClawTrigger(GameObject* other, PhysicsEvent event) {
+        // Only birbs that are still in the pile can be grabbed
+        const PrizeComponent* prize = gameObjects->GetScene().GetPrize(other->GetEntity());
+        if (!prize || prize->state != PrizeState::Active) return;
+
+        if (event == PhysicsEvent::Exit) {
+            if (triggeredBirb == other) {
+                triggeredBirb = nullptr;
+            }
+        }
+        else if (!triggeredBirb) {
+            triggeredBirb = other; // First birb to touch the trigger wins
+        }
+    }
+
+    // Returns the birb that can be picked up
+    GameObject* CanDirectPickupBirb(glm::vec3 cameraPos) {
+        // Only birbs still in the pile, carried and collected ones aren't in this list
+        Scene& scene = gameObjects->GetScene();
+        for (Entity entity : scene.PrizesIn(PrizeState::Active)) {
+            PhysicsComponent* body = scene.bodies.Get(entity);
+            if (!body || !body->rigidBody) continue;
+
+            const rp3d::Vector3& bodyPos = body->rigidBody->getTransform().getPosition();
+            glm::vec3 birbWorldPos = glm::vec3(bodyPos.x, bodyPos.y, bodyPos.z);
+
+            float distance = glm::distance(cameraPos, birbWorldPos);
+            if (distance < 2.0f) {
+                return static_cast<GameObject*>(body->rigidBody->getUserData()); // Return the first birb within range
+            }
+        }
+
+        return nullptr;
+    }
+
+    void UpdateBirbPhysics() {
+        if (!pickedUpBirb || !claw) return;
+
+        // Birb's world transform from the scene graph (claw -> birb)
+        glm::mat4 birbWorldTransform = pickedUpBirb->GetWorldTransform();
+
+        // Extract position and rotation from world transform
+        glm::vec3 worldPosition = glm::vec3(birbWorldTransform[3]);
+        glm::quat worldRotation = glm::quat_cast(birbWorldTransform);
+
+        // Update birb's physics body to match visual position
+        rp3d::Vector3 rp3dPos(worldPosition.x, worldPosition.y, worldPosition.z);
+        rp3d::Quaternion rp3dRot(worldRotation.x, worldRotation.y, worldRotation.z, worldRotation.w);
+        rp3d::Transform physicsTransform(rp3dPos, rp3dRot);
+
+        pickedUpBirb->GetRigidBody()->setTransform(physicsTransform);
+    }
+
+    void SetBirbState(GameObject* birb, PrizeState state) {
+        gameObjects->GetScene().SetPrizeState(birb->GetEntity(), state);
+
+        // Its Exit event is dropped once it's out of the pile, so forget it here or the claw would grab it later
+        if (birb == triggeredBirb && state != PrizeState::Active) {
+            triggeredBirb = nullptr;
+        }
+
+        // Collected birbs are out of the game, nothing left to draw
+        birb->SetVisible(state != PrizeState::Collected);
+    }
+};
+
+#endif // CLAW_GAME_HPP
@@ -0,0 +1,147 @@
+#ifndef CLUSTER_GRID_HPP
+#define CLUSTER_GRID_HPP
+
+#include <glm/glm.hpp>
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// CPU half of clustered lighting: the view frustum cut into screen tiles times depth slices (deeper with
+// distance), and which lights touch which cluster. No GL, LightClusters uploads what this builds.
+class ClusterGrid {
+public:
+    static const int tilesX = 16;
+    static const int tilesY = 9;
+    static const int slices = 24;
+    static const int clusterCount = tilesX * tilesY * slices;
+
+    ClusterGrid() {
+        clusterCounts.resize(clusterCount);
+        clusterRanges.resize(clusterCount * 2);
+    }
+
+    void SetPlanes(float nearPlane, float farPlane) {
+        this->nearPlane = nearPlane;
+        this->farPlane = farPlane;
+    }
+
+    // Adds every light to the clusters its sphere touches, for a perspective projection with the planes
+    // given to SetPlanes. Light indices are positions in lights.
+    void Assign(const std::vector<LightItem>& lights, const glm::mat4& view, const glm::mat4& projection) {
+        // Cluster ranges of every light, then count, prefix sum and fill
+        ranges.clear();
+        std::fill(clusterCounts.begin(), clusterCounts.end(), 0u);
+        for (size_t i = 0; i < lights.size(); i++) {
+            ClusterRange range;
+            if (!FindClusters(lights[i], view, projection, range)) continue;
+            range.light = static_cast<uint32_t>(i);
+            ranges.push_back(range);
+            ForEachCluster(range, [this](int cluster) { clusterCounts[cluster]++; });
+        }
+
+        uint32_t offset = 0;
+        for (int cluster = 0; cluster < clusterCount; cluster++) {
+            clusterRanges[cluster * 2] = offset;
+            clusterRanges[cluster * 2 + 1] = 0;
+            offset += clusterCounts[cluster];
+        }
+        lightIndices.resize(offset);
+        for (const ClusterRange& range : ranges) {
+            ForEachCluster(range, [this, &range](int cluster) {
+                uint32_t& count = clusterRanges[cluster * 2 + 1];
+                lightIndices[clusterRanges[cluster * 2] + count] = range.light;
+                count++;
+            });
+        }
+    }
+
+    static int ClusterIndex(int x, int y, int z) {
+        return x + tilesX * (y + tilesY * z);
+    }
+
+    // First index into GetLightIndices() and count, per cluster
+    const std::vector<uint32_t>& GetClusterRanges() const { return clusterRanges; }
+    const std::vector<uint32_t>& GetLightIndices() const { return lightIndices; }
+    size_t GetAssignedLightCount() const { return ranges.size(); } // Touching at least one cluster
+
+    float GetNearPlane() const { return nearPlane; }
+    float GetFarPlane() const { return farPlane; }
+
+private:
+    struct ClusterRange {
+        int minX, maxX, minY, maxY, minZ, maxZ;
+        uint32_t light;
+    };
+
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+
+    std::vector<ClusterRange> ranges;
+    std::vector<uint32_t> clusterCounts;
+    std::vector<uint32_t> clusterRanges;
+    std::vector<uint32_t> lightIndices;
+
+    int Slice(float depth) const {
+        float slice = std::log(std::max(depth, nearPlane) / nearPlane) / std::log(farPlane / nearPlane) * slices;
+        return std::min(std::max(static_cast<int>(slice), 0), slices - 1);
+    }
+
+    // Conservative: the clusters overlapping the screen rectangle and depth range of the light's sphere
+    bool FindClusters(const LightItem& light, const glm::mat4& view, const glm::mat4& projection, ClusterRange& range) const {
+        glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        float r = light.radius;
+        float nearDepth = -center.z - r;
+        float farDepth = -center.z + r;
+        if (farDepth < nearPlane || nearDepth > farPlane) return false;
+
+        range.minZ = Slice(nearDepth);
+        range.maxZ = Slice(farDepth);
+
+        // Reaches in front of the near plane, could cover any part of the screen
+        if (nearDepth <= nearPlane) {
+            range.minX = 0; range.maxX = tilesX - 1;
+            range.minY = 0; range.maxY = tilesY - 1;
+            return true;
+        }
+
+        // Extremes of the sphere's bounding box in normalized device coordinates
+        float minNdcX = 1.0f, maxNdcX = -1.0f, minNdcY = 1.0f, maxNdcY = -1.0f;
+        const float depths[] = { nearDepth, farDepth };
+        for (float depth : depths) {
+            for (int side = -1; side <= 1; side += 2) {
+                float x = projection[0][0] * (center.x + side * r) / depth;
+                float y = projection[1][1] * (center.y + side * r) / depth;
+                minNdcX = std::min(minNdcX, x); maxNdcX = std::max(maxNdcX, x);
+                minNdcY = std::min(minNdcY, y); maxNdcY = std::max(maxNdcY, y);
+            }
+        }
+        if (maxNdcX < -1.0f || minNdcX > 1.0f || maxNdcY < -1.0f || minNdcY > 1.0f) return false;
+
+        range.minX = Tile(minNdcX, tilesX);
+        range.maxX = Tile(maxNdcX, tilesX);
+        range.minY = Tile(minNdcY, tilesY);
+        range.maxY = Tile(maxNdcY, tilesY);
+        return true;
+    }
+
+    static int Tile(float ndc, int tiles) {
+        int tile = static_cast<int>((ndc * 0.5f + 0.5f) * tiles);
+        return std::min(std::max(tile, 0), tiles - 1);
+    }
+
+    template <typename Function>
+    static void ForEachCluster(const ClusterRange& range, Function f) {
+        for (int z = range.minZ; z <= range.maxZ; z++) {
+            for (int y = range.minY; y <= range.maxY; y++) {
+                for (int x = range.minX; x <= range.maxX; x++) {
+                    f(ClusterIndex(x, y, z));
+                }
+            }
+        }
+    }
+};
+
+#endif // CLUSTER_GRID_HPP
@@ -0,0 +1,16 @@
+#version 330 core
+// Depth pre-pass: position only. Must compute gl_Position exactly like basic.vert, the color pass
+// after it only shades fragments whose depth is EQUAL to what this wrote.
+layout (location = 0) in vec3 inPos;
+
+uniform mat4 uM;
+uniform mat4 uV;
+uniform mat4 uP;
+
+invariant gl_Position;
+
+void main()
+{
+    vec3 fragPos = vec3(uM * vec4(inPos, 1.0));
+    gl_Position = uP * uV * vec4(fragPos, 1.0);
+}
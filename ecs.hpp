@@ -0,0 +1,296 @@
+#ifndef ECS_HPP
+#define ECS_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <reactphysics3d/reactphysics3d.h>
+#include "object_pool.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// An entity is just an id, what it is comes from the components attached to it.
+// Same index + generation scheme as pooled objects, so a destroyed entity's id never matches a new one.
+typedef Handle Entity;
+
+// Index into the Scene's model list. The scene only knows model file paths, the renderer loads the actual
+// meshes and textures for each id, so the simulation never touches GL.
+typedef uint32_t ModelId;
+const ModelId noModel = 0xFFFFFFFF;
+
+// ---------------- Components ----------------
+// Plain data, the systems in systems.hpp do the work
+
+// Local position/rotation/scale (relative to the parent, world for root entities) and the matrices
+// built from them
+struct TransformComponent {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    Entity parent;
+
+    glm::mat4 local = glm::mat4(1.0f);
+    glm::mat4 world = glm::mat4(1.0f);
+    bool localDirty = true;  // local needs to be composed again
+    bool worldDirty = true;  // world needs to be recomputed even if the parent didn't move
+
+    // Bumped whenever world changes. Children remember their parent's version, so a moved parent
+    // is noticed without walking down to every child.
+    uint32_t worldVersion = 0;
+    uint32_t parentVersion = 0;
+};
+
+struct RenderComponent {
+    ModelId model = noModel;
+    bool twoSided = false; // Draw with backface culling off
+    bool visible = true;
+    bool occlusionTest = false; // Small and often covered (prizes), the renderer may skip it while it's hidden
+    bool isStatic = false;      // Never moves (the machine, the ground), the renderer may cache what it draws of it
+};
+
+// Something that gives off light (a bulb, a spotlight, a glowing prize). Offset and direction are local to
+// the entity's transform, so lights follow whatever they're attached to.
+struct LightComponent {
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+    float radius = 1.0f;       // World units, no light past this
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f); // Spotlights only
+    float spotCosine = -1.0f;  // Cosine of the cone's half angle, -1 = point light
+    bool enabled = true;
+};
+
+struct PhysicsComponent {
+    rp3d::RigidBody* rigidBody = nullptr;
+
+    // Physics transform as of the last sync, to skip bodies that haven't moved
+    rp3d::Transform lastTransform;
+    bool hasSynced = false;
+};
+
+// Gameplay state of a prize in the machine
+enum class PrizeState : uint8_t {
+    Active,    // In the pile, can be grabbed
+    Carried,   // Hanging from the claw
+    Collected, // Taken out of play (picked up by the player)
+    Count
+};
+
+struct PrizeComponent {
+    PrizeState state = PrizeState::Active;
+    uint32_t listIndex = 0; // Position in the Scene's list for this state
+};
+
+// One model to draw with its final model matrix. Plain data, so these can be handed to the render thread as-is.
+struct DrawItem {
+    ModelId model;
+    glm::mat4 transform;
+    bool twoSided;      // Draw with backface culling off
+    bool occlusionTest; // See RenderComponent
+    bool isStatic;
+    Entity entity;      // Identifies the object across frames (occlusion query results, cached shadows)
+};
+
+// One light in world space, handed to the render thread like DrawItems
+struct LightItem {
+    glm::vec3 position;
+    float radius;
+    glm::vec3 color;      // Already times the intensity
+    float spotCosine;     // -1 = point light
+    glm::vec3 direction;  // Spotlights only
+};
+
+
+// Components of one type packed together in a dense array (a sparse set). Systems loop over the
+// dense array directly; lookups by entity go through the sparse index. Removing swaps the last
+// component into the hole, so pointers to components only stay valid until the next Add/Remove.
+template <typename T>
+class ComponentArray {
+public:
+    T& Add(Entity entity, const T& component = T()) {
+        if (T* existing = Get(entity)) {
+            *existing = component;
+            return *existing;
+        }
+
+        if (entity.index >= sparse.size()) {
+            sparse.resize(entity.index + 1, invalidIndex);
+        }
+        sparse[entity.index] = static_cast<uint32_t>(components.size());
+        components.push_back(component);
+        entities.push_back(entity);
+        return components.back();
+    }
+
+    void Remove(Entity entity) {
+        if (!Get(entity)) return;
+
+        uint32_t removed = sparse[entity.index];
+        uint32_t last = static_cast<uint32_t>(components.size() - 1);
+        if (removed != last) {
+            components[removed] = components[last];
+            entities[removed] = entities[last];
+            sparse[entities[removed].index] = removed;
+        }
+        components.pop_back();
+        entities.pop_back();
+        sparse[entity.index] = invalidIndex;
+    }
+
+    // nullptr if the entity doesn't have one (or is gone)
+    T* Get(Entity entity) {
+        if (entity.index >= sparse.size()) return nullptr;
+
+        uint32_t dense = sparse[entity.index];
+        if (dense == invalidIndex || entities[dense] != entity) return nullptr;
+        return &components[dense];
+    }
+
+    bool Has(Entity entity) {
+        return Get(entity) != nullptr;
+    }
+
+    // Dense access for systems, component i belongs to EntityAt(i)
+    size_t Size() const { return components.size(); }
+    T& operator[](size_t i) { return components[i]; }
+    Entity EntityAt(size_t i) const { return entities[i]; }
+
+    void Reserve(size_t count) {
+        components.reserve(count);
+        entities.reserve(count);
+    }
+
+private:
+    enum : uint32_t { invalidIndex = 0xFFFFFFFF };
+
+    std::vector<T> components;
+    std::vector<Entity> entities;
+    std::vector<uint32_t> sparse; // entity index -> position in components
+};
+
+
+// Hands out entities and holds every component array
+class Scene {
+public:
+    ComponentArray<TransformComponent> transforms;
+    ComponentArray<RenderComponent> renders;
+    ComponentArray<PhysicsComponent> bodies;
+    ComponentArray<LightComponent> lights;
+
+    explicit Scene(size_t reserve = 0) {
+        generations.reserve(reserve);
+        transforms.Reserve(reserve);
+        renders.Reserve(reserve);
+        bodies.Reserve(reserve);
+        lights.Reserve(reserve);
+        prizes.Reserve(reserve);
+    }
+
+    Entity CreateEntity() {
+        Entity entity;
+        if (!freeIndices.empty()) {
+            entity.index = freeIndices.back();
+            freeIndices.pop_back();
+        }
+        else {
+            entity.index = static_cast<uint32_t>(generations.size());
+            generations.push_back(0);
+        }
+        entity.generation = generations[entity.index];
+        return entity;
+    }
+
+    // Drops all of the entity's components. Doesn't touch the rigid body, whoever created it destroys it.
+    void DestroyEntity(Entity entity) {
+        if (!IsAlive(entity)) return;
+
+        transforms.Remove(entity);
+        renders.Remove(entity);
+        bodies.Remove(entity);
+        lights.Remove(entity);
+        if (const PrizeComponent* prize = prizes.Get(entity)) {
+            RemoveFromList(*prize);
+            prizes.Remove(entity);
+        }
+
+        generations[entity.index]++;
+        freeIndices.push_back(entity.index);
+    }
+
+    bool IsAlive(Entity entity) const {
+        return entity.index < generations.size() && generations[entity.index] == entity.generation;
+    }
+
+    // ---------------- Models ----------------
+
+    // Same path, same id
+    ModelId RegisterModel(const std::string& path) {
+        for (size_t i = 0; i < modelPaths.size(); i++) {
+            if (modelPaths[i] == path) return static_cast<ModelId>(i);
+        }
+        modelPaths.push_back(path);
+        return static_cast<ModelId>(modelPaths.size() - 1);
+    }
+
+    size_t ModelCount() const { return modelPaths.size(); }
+    const std::string& GetModelPath(ModelId model) const { return modelPaths[model]; }
+
+    // ---------------- Prizes ----------------
+    // Each state keeps a list of the prizes in it, updated on every state change, so per-step loops
+    // can go over just the active prizes instead of checking every prize's state.
+
+    void AddPrize(Entity entity) {
+        if (prizes.Has(entity)) return;
+
+        PrizeComponent& prize = prizes.Add(entity);
+        AddToList(entity, prize);
+    }
+
+    void SetPrizeState(Entity entity, PrizeState state) {
+        PrizeComponent* prize = prizes.Get(entity);
+        if (!prize || prize->state == state) return;
+
+        RemoveFromList(*prize);
+        prize->state = state;
+        AddToList(entity, *prize);
+    }
+
+    // nullptr if the entity isn't a prize
+    const PrizeComponent* GetPrize(Entity entity) {
+        return prizes.Get(entity);
+    }
+
+    const std::vector<Entity>& PrizesIn(PrizeState state) const {
+        return prizeLists[static_cast<int>(state)];
+    }
+
+private:
+    // Use AddPrize/SetPrizeState, they keep the state lists in sync
+    ComponentArray<PrizeComponent> prizes;
+    std::vector<Entity> prizeLists[static_cast<int>(PrizeState::Count)];
+
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeIndices;
+
+    std::vector<std::string> modelPaths; // Indexed by ModelId
+
+    void AddToList(Entity entity, PrizeComponent& prize) {
+        std::vector<Entity>& list = prizeLists[static_cast<int>(prize.state)];
+        prize.listIndex = static_cast<uint32_t>(list.size());
+        list.push_back(entity);
+    }
+
+    // Swaps the last entry into the hole
+    void RemoveFromList(const PrizeComponent& prize) {
+        std::vector<Entity>& list = prizeLists[static_cast<int>(prize.state)];
+        Entity moved = list.back();
+        list[prize.listIndex] = moved;
+        list.pop_back();
+        if (prize.listIndex < list.size()) {
+            prizes.Get(moved)->listIndex = prize.listIndex;
+        }
+    }
+};
+
+#endif // ECS_HPP
@@ -5,40 +5,83 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <reactphysics3d/reactphysics3d.h>
-#include "model.hpp"
-#include "shader.hpp"
+#include "ecs.hpp"
+#include "log.hpp"
+#include "mesh_data.hpp"
+#include "systems.hpp"
+#include "object_pool.hpp"
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
 
+// Phase of a contact/trigger pair, as reported by the physics step
+enum class PhysicsEvent {
+    Enter,
+    Stay,
+    Exit
+};
+
+class GameObject;
+
+// First contact found by GameObject::Sweep
+struct SweepHit {
+    bool hit = false;
+    float fraction = 1.0f;               // Time of impact along the swept path (0 = start, 1 = end)
+    glm::vec3 normal = glm::vec3(0.0f);  // Surface normal at the contact, facing the mover
+    GameObject* other = nullptr;
+};
+
+// Scene object with a convenient interface for game code. The data itself lives in the scene's
+// component arrays (see ecs.hpp), keyed by this object's entity, so systems can iterate over just
+// the transforms, bodies or models without going through GameObjects.
+// Simulation only: the model is just an id, drawing is up to the renderer (see scene_renderer.hpp).
 class GameObject {
 public: 
-    Model* model;
-    glm::mat4 transform;
     std::vector<GameObject*> children;
+    GameObject* parent;
     
 private:
-    std::vector<rp3d::Vector3> collisionVertices;
-    std::vector<int> collisionIndices;
-    std::vector<float> collisionVertexArray;
+    Scene* scene;
+    Entity entity;
+
+    // Triangles rp3d's mesh shapes point into, so they have to live as long as the object. Only objects with
+    // a mesh collider have them, prizes with a box stay small and don't allocate them.
+    struct CollisionMesh {
+        std::vector<rp3d::Vector3> vertices;
+        std::vector<int> indices;
+        std::vector<float> vertexArray;
+    };
+    std::unique_ptr<CollisionMesh> collisionMesh;
+
+    Handle handle;
+    friend class GameObjectManager;
 
 public:
-    // Physics
-    rp3d::RigidBody* rigidBody;
-    
-    // Transform properties for physics sync
-    glm::vec3 position;
-    glm::quat rotation;
-    glm::vec3 scale;
-
-    // Constructor
-    GameObject(const char* path, rp3d::PhysicsWorld* world, rp3d::BodyType bodyType = rp3d::BodyType::STATIC) {
-        model = new Model(path);
-        transform = glm::mat4(1.0f);
-        rigidBody = nullptr;
-        position = glm::vec3(0.0f);
-        rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-        scale = glm::vec3(1.0f);
+    // World the rigid body lives in, nullptr without physics
+    rp3d::PhysicsWorld* physicsWorld;
+
+    // Event callbacks, called by PhysicsEventListener once per physics step while touching
+    std::function<void(GameObject* other, PhysicsEvent event)> onContact;
+    std::function<void(GameObject* other, PhysicsEvent event)> onTrigger;
+
+    // Constructor. Objects with the same model path share one model id (and one loaded Model in the renderer)
+    GameObject(Scene& scene, const std::string& modelPath, rp3d::PhysicsWorld* world, rp3d::BodyType bodyType = rp3d::BodyType::STATIC)
+        : GameObject(scene, scene.RegisterModel(modelPath), world, bodyType) {}
+
+    // Same with a model id that's already registered, skips looking the path up (prizes spawned by the hundred)
+    GameObject(Scene& scene, ModelId model, rp3d::PhysicsWorld* world, rp3d::BodyType bodyType = rp3d::BodyType::STATIC)
+        : scene(&scene) {
+        parent = nullptr;
+        physicsWorld = nullptr;
+
+        entity = scene.CreateEntity();
+        scene.transforms.Add(entity);
+        RenderComponent render;
+        render.model = model;
+        scene.renders.Add(entity, render);
     
         // Auto-create physics if world provided
         if (world != nullptr) {
@@ -47,114 +90,278 @@ public:
     }
 
     
-    // Destructor
+    // Destructor. Children are owned by the GameObjectManager too, they just get detached
     ~GameObject() {
-        delete model;
+        if (parent) {
+            parent->RemoveChild(this);
+        }
         for (auto child : children) {
-            delete child;
+            child->parent = nullptr;
+            child->Transform().parent = Entity();
+            child->Transform().worldDirty = true;
+        }
+        rp3d::RigidBody* rigidBody = GetRigidBody();
+        if (rigidBody && physicsWorld) {
+            physicsWorld->destroyRigidBody(rigidBody);
         }
+        scene->DestroyEntity(entity);
+    }
+    
+    
+    // Set by the GameObjectManager that created this object
+    Handle GetHandle() const { return handle; }
+    
+    Entity GetEntity() const { return entity; }
+    
+    ModelId GetModel() {
+        return scene->renders.Get(entity)->model;
+    }
+    
+    // nullptr without physics
+    rp3d::RigidBody* GetRigidBody() {
+        PhysicsComponent* body = scene->bodies.Get(entity);
+        return body ? body->rigidBody : nullptr;
+    }
+    
+    
+    void SetVisible(bool visible) {
+        scene->renders.Get(entity)->visible = visible;
+    }
+    
+    
+    void SetTwoSided(bool twoSided) {
+        scene->renders.Get(entity)->twoSided = twoSided;
+    }
+    
+    
+    // Lets the renderer skip drawing this object while an occlusion query says it's covered
+    void SetOcclusionTest(bool occlusionTest) {
+        scene->renders.Get(entity)->occlusionTest = occlusionTest;
+    }
+    
+    
+    // Promises the renderer this object won't move, so it can cache things like its shadow
+    void SetStatic(bool isStatic) {
+        scene->renders.Get(entity)->isStatic = isStatic;
+    }
+    
+    
+    // Makes this object give off light, replaces the light it already had
+    void SetLight(const LightComponent& light) {
+        scene->lights.Add(entity, light);
     }
     
     
+    // Splits the matrix into position/rotation/scale once, prefer the component setters
     void SetTransform(const glm::mat4& newTransform) {
-        transform = newTransform;
-        position = glm::vec3(transform[3]);
-        rotation = glm::quat_cast(transform);
-        SyncPhysicsFromTransform();
+        TransformComponent& transform = Transform();
+        transform.position = glm::vec3(newTransform[3]);
+        transform.scale = glm::vec3(glm::length(glm::vec3(newTransform[0])),
+                                    glm::length(glm::vec3(newTransform[1])),
+                                    glm::length(glm::vec3(newTransform[2])));
+        glm::mat3 rotationMatrix(glm::vec3(newTransform[0]) / transform.scale.x,
+                                 glm::vec3(newTransform[1]) / transform.scale.y,
+                                 glm::vec3(newTransform[2]) / transform.scale.z);
+        transform.rotation = glm::normalize(glm::quat_cast(rotationMatrix));
+        TransformChanged();
+    }
+    
+    
+    void SetPosition(glm::vec3 newPosition) {
+        Transform().position = newPosition;
+        TransformChanged();
     }
     
     
+    void SetRotation(glm::quat newRotation) {
+        Transform().rotation = glm::normalize(newRotation);
+        TransformChanged();
+    }
+    
+    
+    // All three at once, one physics sync
+    void SetTRS(glm::vec3 newPosition, glm::quat newRotation, glm::vec3 newScale) {
+        TransformComponent& transform = Transform();
+        transform.position = newPosition;
+        transform.rotation = glm::normalize(newRotation);
+        transform.scale = newScale;
+        TransformChanged();
+    }
+    
+    
+    glm::vec3 GetPosition() { return Transform().position; }
+    glm::quat GetRotation() { return Transform().rotation; }
+    glm::vec3 GetScale() { return Transform().scale; }
+    
+    
     void AddChild(GameObject* child) {
+        if (child->parent) {
+            child->parent->RemoveChild(child);
+        }
         children.push_back(child);
+        child->parent = this;
+        child->Transform().parent = entity;
+        child->Transform().worldDirty = true;
     }
     
     
     void RemoveChild(GameObject* child) {
         auto it = std::remove(children.begin(), children.end(), child);
+        if (it == children.end()) return;
+        
         children.erase(it, children.end());
+        child->parent = nullptr;
+        child->Transform().parent = Entity();
+        child->Transform().worldDirty = true;
+    }
+    
+    
+    // World matrix, recomputed lazily up the parent chain only where something changed
+    const glm::mat4& GetWorldTransform() {
+        return TransformSystem::GetWorld(*scene, Transform());
     }
     
 
+    // Rotates around a local axis
     void Rotate(float angle, glm::vec3 axis) {
-        transform = glm::rotate(transform, glm::radians(angle), axis);
-        // Extract new rotation from the updated matrix
-        rotation = glm::quat_cast(transform); 
-        SyncPhysicsFromTransform();
+        TransformComponent& transform = Transform();
+        transform.rotation = glm::normalize(transform.rotation * glm::angleAxis(glm::radians(angle), glm::normalize(axis)));
+        TransformChanged();
     }
 
     
+    // Offset is in local space (rotated and scaled), same as glm::translate on the model matrix
     void Translate(glm::vec3 positionOffset) {
-        transform = glm::translate(transform, positionOffset);
-        // Update local position variable from matrix translation column
-        this->position = glm::vec3(transform[3]); 
-        SyncPhysicsFromTransform();
+        Transform().position += LocalToWorldOffset(positionOffset);
+        TransformChanged();
     }
 
     
-    void Scale(glm::vec3 newScale) {
-        this->scale = newScale;
-        // Rebuild the transform matrix from position, rotation, and scale
-        transform = glm::mat4(1.0f);
-        transform = glm::translate(transform, position);
-        transform = transform * glm::mat4_cast(rotation);
-        transform = glm::scale(transform, newScale);
-        SyncPhysicsFromTransform();
+    // Like Translate, but stops exactly at the first contact with the obstacles instead of overlapping them.
+    // With slide on, whatever motion is left continues along the surface that was hit (e.g. a wall).
+    SweepHit SweepTranslate(glm::vec3 positionOffset, const std::vector<GameObject*>& obstacles, bool slide = true) {
+        const float skin = 0.001f; // Stay this far off surfaces so the next sweep doesn't start in contact
+        
+        // Same local offset as Translate, turned into a world space move
+        glm::vec3 remaining = LocalToWorldOffset(positionOffset);
+        SweepHit firstHit;
+        
+        for (int iteration = 0; iteration < 3; iteration++) {
+            float length = glm::length(remaining);
+            if (length <= skin) break;
+            
+            SweepHit hit = Sweep(remaining, obstacles);
+            if (!hit.hit) {
+                TranslateWorld(remaining);
+                break;
+            }
+            if (!firstHit.hit) firstHit = hit;
+            
+            float travel = std::max(hit.fraction * length - skin, 0.0f);
+            TranslateWorld(remaining * (travel / length));
+            if (!slide) break;
+            
+            // Drop the part of the leftover motion that pushes into the surface
+            remaining *= (1.0f - hit.fraction);
+            remaining -= hit.normal * glm::dot(remaining, hit.normal);
+        }
+        
+        return firstHit;
     }
     
+    
+    // Sweeps this body's box colliders along worldDelta and returns the earliest hit against the obstacles.
+    // Rays go out from the corners, edge/face midpoints and center of each box, so one call gives both the
+    // time of impact and the contact normal.
+    SweepHit Sweep(glm::vec3 worldDelta, const std::vector<GameObject*>& obstacles) {
+        SweepHit result;
+        rp3d::RigidBody* rigidBody = GetRigidBody();
+        if (!rigidBody || glm::length(worldDelta) <= 0.0f) return result;
+        
+        rp3d::Vector3 delta(worldDelta.x, worldDelta.y, worldDelta.z);
+        
+        for (uint32_t i = 0; i < rigidBody->getNbColliders(); i++) {
+            rp3d::Collider* collider = rigidBody->getCollider(i);
+            if (collider->getIsTrigger()) continue;
+            if (collider->getCollisionShape()->getName() != rp3d::CollisionShapeName::BOX) continue;
+            
+            const rp3d::BoxShape* box = static_cast<const rp3d::BoxShape*>(collider->getCollisionShape());
+            const rp3d::Vector3& half = box->getHalfExtents();
+            const rp3d::Transform toWorld = collider->getLocalToWorldTransform();
+            
+            // 3x3x3 grid of sample points over the box
+            for (int sample = 0; sample < 27; sample++) {
+                rp3d::Vector3 local(
+                    half.x * static_cast<float>(sample % 3 - 1),
+                    half.y * static_cast<float>((sample / 3) % 3 - 1),
+                    half.z * static_cast<float>(sample / 9 - 1)
+                );
+                rp3d::Vector3 start = toWorld * local;
+                rp3d::Ray ray(start, start + delta);
+                
+                for (GameObject* obstacle : obstacles) {
+                    if (!obstacle || obstacle == this) continue;
+                    rp3d::RigidBody* obstacleBody = obstacle->GetRigidBody();
+                    if (!obstacleBody) continue;
+                    
+                    rp3d::RaycastInfo info;
+                    if (obstacleBody->raycast(ray, info) && info.hitFraction < result.fraction) {
+                        result.hit = true;
+                        result.fraction = info.hitFraction;
+                        result.normal = glm::vec3(info.worldNormal.x, info.worldNormal.y, info.worldNormal.z);
+                        result.other = obstacle;
+                    }
+                }
+            }
+        }
+        
+        // Hits on the inside of the cabinet come back with the outward normal, flip it towards the mover
+        if (result.hit && glm::dot(result.normal, worldDelta) > 0.0f) {
+            result.normal = -result.normal;
+        }
+        
+        return result;
+    }
 
-    void Draw(Shader& shader) {
-        shader.setMat4("uM", transform);
-        model->Draw(shader);
+    
+    void Scale(glm::vec3 newScale) {
+        Transform().scale = newScale;
+        TransformChanged();
+    }
+    
 
-        // Draw children with parent's transform applied
-        for (auto child : children) {
-            glm::mat4 childTransform = transform * child->GetTransform();
-            shader.setMat4("uM", childTransform);
-            child->model->Draw(shader);
-        }
+    void TranslateWorld(glm::vec3 worldOffset) {
+        Transform().position += worldOffset;
+        TransformChanged();
     }
     
 
-    glm::mat4 GetTransform() const {
-        return transform;
+    // Local matrix, composed from position/rotation/scale only when one of them changed
+    const glm::mat4& GetTransform() {
+        return TransformSystem::GetLocal(Transform());
     }
     
     
     void SyncPhysicsFromTransform() {
+        rp3d::RigidBody* rigidBody = GetRigidBody();
         if (!rigidBody) return;
 
         // Update Position and Rotation (RigidBody level)
-        rp3d::Vector3 rp3dPos(position.x, position.y, position.z);
-        rp3d::Quaternion rp3dRot(rotation.x, rotation.y, rotation.z, rotation.w);
+        const TransformComponent& transform = Transform();
+        rp3d::Vector3 rp3dPos(transform.position.x, transform.position.y, transform.position.z);
+        rp3d::Quaternion rp3dRot(transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w);
         rp3d::Transform physicsTransform(rp3dPos, rp3dRot);
     
         rigidBody->setTransform(physicsTransform);
-
-        // Update Scale (Collider level)
-        // ReactPhysics3D requires updating the scale on each collider attached to the body
-        for (uint32_t i = 0; i < rigidBody->getNbColliders(); i++) {
-            rp3d::Collider* collider = rigidBody->getCollider(i);
-        }
     }
     
     
-    void SyncTransformFromPhysics() {
-        if (!rigidBody) return;
-    
-        const rp3d::Transform& pTransform = rigidBody->getTransform();
-    
-        // Update local Pos/Rot variables
-        const rp3d::Vector3& pos = pTransform.getPosition();
-        position = glm::vec3(pos.x, pos.y, pos.z);
-    
-        const rp3d::Quaternion& rot = pTransform.getOrientation();
-        rotation = glm::quat(rot.w, rot.x, rot.y, rot.z);
-    
-        // Rebuild the Model Matrix
-        transform = glm::mat4(1.0f);
-        transform = glm::translate(transform, position);
-        transform = transform * glm::mat4_cast(rotation);
-        transform = glm::scale(transform, scale);
+    // Returns false without touching anything when the body is asleep or hasn't moved since the last sync
+    // (unless forced). PhysicsSyncSystem does this for every dynamic body at once.
+    bool SyncTransformFromPhysics(bool force = false) {
+        PhysicsComponent* body = scene->bodies.Get(entity);
+        if (!body) return false;
+        return PhysicsSyncSystem::Sync(*body, Transform(), force);
     }
     
     
@@ -164,30 +371,48 @@ public:
     
     
     void CreatePhysicsBody(rp3d::PhysicsWorld* world, rp3d::BodyType bodyType) {
-        rp3d::Vector3 pos(position.x, position.y, position.z);
-        rp3d::Quaternion rot(rotation.x, rotation.y, rotation.z, rotation.w);
+        const TransformComponent& transform = Transform();
+        rp3d::Vector3 pos(transform.position.x, transform.position.y, transform.position.z);
+        rp3d::Quaternion rot(transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w);
         rp3d::Transform physicsTransform(pos, rot);
-        rigidBody = world->createRigidBody(physicsTransform);
+        rp3d::RigidBody* rigidBody = world->createRigidBody(physicsTransform);
         rigidBody->setType(bodyType);
+        physicsWorld = world;
+        // Lets the event listener map bodies back to their GameObject
+        rigidBody->setUserData(this);
+
+        PhysicsComponent body;
+        body.rigidBody = rigidBody;
+        scene->bodies.Add(entity, body);
     }
     
     
-    void AddConcaveCollision(rp3d::PhysicsCommon& physicsCommon) {
-        if (!rigidBody || !model) return;
+    // Trigger colliders report overlaps but never push other bodies around
+    void SetIsTrigger(bool isTrigger) {
+        rp3d::RigidBody* rigidBody = GetRigidBody();
+        if (!rigidBody) return;
+
+        for (uint32_t i = 0; i < rigidBody->getNbColliders(); i++) {
+            rigidBody->getCollider(i)->setIsTrigger(isTrigger);
+        }
+    }
     
-        // Store in member variables so the data stays alive!
-        collisionVertices.clear();
-        collisionIndices.clear();
     
-        model->GetMeshDataForPhysics(collisionVertices, collisionIndices, scale);
+    // Mesh is in model space, the current scale is baked in
+    void AddConcaveCollision(rp3d::PhysicsCommon& physicsCommon, const MeshData& mesh) {
+        rp3d::RigidBody* rigidBody = GetRigidBody();
+        if (!rigidBody || mesh.indices.empty()) return;
+    
+        // Store in member variables so the data stays alive!
+        SetCollisionMesh(mesh);
     
         // Create triangle vertex array for concave mesh
         rp3d::TriangleVertexArray triangleArray(
-            collisionVertices.size(),
-            &collisionVertices[0],
+            collisionMesh->vertices.size(),
+            &collisionMesh->vertices[0],
             sizeof(rp3d::Vector3),
-            collisionIndices.size() / 3,
-            collisionIndices.data(),
+            collisionMesh->indices.size() / 3,
+            collisionMesh->indices.data(),
             3 * sizeof(int),
             rp3d::TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE,
             rp3d::TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE
@@ -198,52 +423,51 @@ public:
         std::vector<rp3d::Message> messages;
         rp3d::TriangleMesh* triangleMesh = physicsCommon.createTriangleMesh(triangleArray, messages);
         
-        std::cout << "=== Triangle Mesh Messages ===" << std::endl;
         for (const auto& msg : messages) {
-            std::cout << "Message: " << msg.text << std::endl;
+            Log::Info("Triangle mesh: ", msg.text);
         }
     
         rp3d::ConcaveMeshShape* concaveShape = physicsCommon.createConcaveMeshShape(triangleMesh);
+        // Sweeps start inside the cabinet, so rays have to hit the back side of its walls too
+        concaveShape->setRaycastTestType(rp3d::TriangleRaycastSide::FRONT_AND_BACK);
     
         rigidBody->addCollider(concaveShape, rp3d::Transform::identity());
     
-        std::cout << "Added Concave collision with " << collisionIndices.size() / 3 << " triangles." << std::endl;
+        Log::Info("Added Concave collision with ", collisionMesh->indices.size() / 3, " triangles.");
     }
     
     
-    void AddConvexCollision(rp3d::PhysicsCommon& physicsCommon) {
+    void AddConvexCollision(rp3d::PhysicsCommon& physicsCommon, const MeshData& mesh) {
+        rp3d::RigidBody* rigidBody = GetRigidBody();
         if (!rigidBody) {
-            std::cout << "Error: RigidBody must be created before adding mesh collision!" << std::endl;
+            Log::Error("RigidBody must be created before adding mesh collision!");
             return;
         }
         
-        if (!model) {
-            std::cout << "Error: Model not loaded!" << std::endl;
+        if (mesh.indices.empty()) {
+            Log::Error("Mesh not loaded!");
             return;
         }
         
         // Store in member variables so the data stays alive!
-        collisionVertices.clear();
-        collisionIndices.clear();
-        collisionVertexArray.clear();
-        
-        // Get mesh data from model
-        model->GetMeshDataForPhysics(collisionVertices, collisionIndices, scale);
+        SetCollisionMesh(mesh);
+        std::vector<float>& vertexArray = collisionMesh->vertexArray;
+        vertexArray.clear();
         
         // Convert to float arrays for ReactPhysics3D
-        for (const auto& v : collisionVertices) {
-            collisionVertexArray.push_back(v.x);
-            collisionVertexArray.push_back(v.y);
-            collisionVertexArray.push_back(v.z);
+        for (const auto& v : collisionMesh->vertices) {
+            vertexArray.push_back(v.x);
+            vertexArray.push_back(v.y);
+            vertexArray.push_back(v.z);
         }
         
         // Create TriangleVertexArray
         rp3d::TriangleVertexArray triangleArray(
-            static_cast<rp3d::uint32>(collisionVertices.size()),
-            collisionVertexArray.data(),
+            static_cast<rp3d::uint32>(collisionMesh->vertices.size()),
+            vertexArray.data(),
             3 * sizeof(float),
-            static_cast<rp3d::uint32>(collisionIndices.size() / 3),
-            collisionIndices.data(),
+            static_cast<rp3d::uint32>(collisionMesh->indices.size() / 3),
+            collisionMesh->indices.data(),
             3 * sizeof(int),
             rp3d::TriangleVertexArray::VertexDataType::VERTEX_FLOAT_TYPE,
             rp3d::TriangleVertexArray::IndexDataType::INDEX_INTEGER_TYPE
@@ -259,13 +483,14 @@ public:
         // Add the collider to the rigid body
         rigidBody->addCollider(meshShape, rp3d::Transform::identity());
         
-        std::cout << "Added mesh collision with " << collisionIndices.size() / 3 << " triangles" << std::endl;
+        Log::Info("Added mesh collision with ", collisionMesh->indices.size() / 3, " triangles");
     }
     
     
     void AddBoxCollision(rp3d::PhysicsCommon& physicsCommon, glm::vec3 halfExtents) {
+        rp3d::RigidBody* rigidBody = GetRigidBody();
         if (!rigidBody) {
-            std::cout << "Error: RigidBody must be created before adding box collision!" << std::endl;
+            Log::Error("RigidBody must be created before adding box collision!");
             return;
         }
         
@@ -275,9 +500,21 @@ public:
         rigidBody->addCollider(boxShape, rp3d::Transform::identity());
     }
     
+    // Adds a shape someone else owns and destroys, e.g. one box shared by every prize of a type
+    void AddSharedCollision(rp3d::CollisionShape* shape) {
+        rp3d::RigidBody* rigidBody = GetRigidBody();
+        if (!rigidBody) {
+            Log::Error("RigidBody must be created before adding shared collision!");
+            return;
+        }
+
+        rigidBody->addCollider(shape, rp3d::Transform::identity());
+    }
+    
     void AddSphereCollision(rp3d::PhysicsCommon& physicsCommon, float radius) {
+        rp3d::RigidBody* rigidBody = GetRigidBody();
         if (!rigidBody) {
-            std::cout << "Error: RigidBody must be created before adding sphere collision!" << std::endl;
+            Log::Error("RigidBody must be created before adding sphere collision!");
             return;
         }
     
@@ -285,6 +522,87 @@ public:
         rigidBody->addCollider(sphereShape, rp3d::Transform::identity());
     }
 
+private:
+    TransformComponent& Transform() {
+        return *scene->transforms.Get(entity);
+    }
+    
+    
+    // Copies the mesh into collisionMesh, scaled by the current scale
+    void SetCollisionMesh(const MeshData& mesh) {
+        const glm::vec3 scale = Transform().scale;
+
+        if (!collisionMesh) {
+            collisionMesh.reset(new CollisionMesh());
+        }
+        collisionMesh->vertices.clear();
+        collisionMesh->vertices.reserve(mesh.positions.size());
+        for (const glm::vec3& position : mesh.positions) {
+            collisionMesh->vertices.push_back(rp3d::Vector3(position.x * scale.x, position.y * scale.y, position.z * scale.z));
+        }
+        collisionMesh->indices.assign(mesh.indices.begin(), mesh.indices.end());
+    }
+    
+    
+    // Matrices get rebuilt next time they're needed, the body follows right away
+    void TransformChanged() {
+        TransformSystem::MarkChanged(Transform());
+        SyncPhysicsFromTransform();
+    }
+    
+    
+    glm::vec3 LocalToWorldOffset(glm::vec3 offset) {
+        const TransformComponent& transform = Transform();
+        return transform.rotation * (transform.scale * offset);
+    }
+
+};
+
+// Owns every GameObject and the Scene holding their components. Objects live in a pool (see ObjectPool),
+// so spawning and despawning prizes during play reuses slots instead of going through new/delete.
+// Destroying an object also removes its rigid body from the physics world, so Clear() has to run before
+// the world is destroyed.
+class GameObjectManager {
+public:
+    explicit GameObjectManager(size_t reserve = 0) : scene(reserve), pool(reserve) {}
+
+    // Same arguments as the GameObject constructors, minus the scene
+    template <typename... Args>
+    GameObject* Create(Args&&... args) {
+        Handle handle = pool.Create(scene, std::forward<Args>(args)...);
+        GameObject* object = pool.Get(handle);
+        object->handle = handle;
+        return object;
+    }
+
+    // nullptr once the object has been destroyed, even if its slot was reused
+    GameObject* Get(Handle handle) {
+        return pool.Get(handle);
+    }
+
+    void Destroy(GameObject* object) {
+        if (object) {
+            pool.Destroy(object->handle);
+        }
+    }
+
+    void Destroy(Handle handle) {
+        pool.Destroy(handle);
+    }
+
+    void Clear() {
+        pool.Clear();
+    }
+
+    size_t Count() const { return pool.Count(); }
+    size_t Capacity() const { return pool.Capacity(); } // Slots allocated, live or free
+
+    Scene& GetScene() { return scene; }
+
+private:
+    // Declared first so it outlives the objects, their destructors remove their components
+    Scene scene;
+    ObjectPool<GameObject> pool;
 };
 
 #endif // GAMEOBJECT_HPP
\ No newline at end of file
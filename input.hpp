@@ -0,0 +1,218 @@
+#ifndef INPUT_HPP
+#define INPUT_HPP
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Every key the game reacts to
+enum class InputKey : uint8_t {
+    W, A, S, D,
+    E, C, F, G,
+    Space, Escape,
+    Left, Right, Up, Down,
+    Z, O, T, P,
+    Count
+};
+
+// Everything read from the window during one frame, plus how long the frame took.
+// This is exactly what gets recorded, so a replay sees the same thing the live session did.
+struct InputFrame {
+    float deltaTime = 0.0f;
+    uint32_t keys = 0;       // Bit per InputKey, set while held
+    float mouseX = 0.0f;     // Last cursor position this frame
+    float mouseY = 0.0f;
+    float scroll = 0.0f;     // Scroll wheel, summed over the frame
+    uint8_t mouseMoved = 0;  // Cursor moved this frame
+    uint8_t padding[3] = {};
+};
+
+// Settings a session depends on, stored with the recording so the replay starts from the same scene
+struct InputSession {
+    int32_t prizeCount = 0;
+    double stepTime = 1.0 / 60.0;
+    uint64_t pileHash = 0; // ClawGame::GetPileHash, a replay on a different pile would play out differently
+};
+
+// Per-frame input from the window, a recording, or both (recording a live session).
+// The game reads keys and mouse only through here, never straight from GLFW.
+class Input {
+public:
+    ~Input() {
+        StopRecording();
+    }
+
+    // Live input is written to path as it's read. session.pileHash must be set, start once the game exists.
+    bool StartRecording(const std::string& path, const InputSession& session) {
+        recordFile.open(path, std::ios::binary);
+        if (!recordFile) {
+            std::cout << "Error: could not create input recording " << path << std::endl;
+            return false;
+        }
+
+        uint32_t magic = fileMagic;
+        uint32_t version = fileVersion;
+        Write(recordFile, magic);
+        Write(recordFile, version);
+        // Field by field, the struct's padding isn't part of the file
+        Write(recordFile, session.prizeCount);
+        Write(recordFile, session.stepTime);
+        Write(recordFile, session.pileHash);
+        recordedFrames = 0;
+
+        std::cout << "Recording input to " << path << std::endl;
+        return true;
+    }
+
+    void StopRecording() {
+        if (!recordFile.is_open()) return;
+
+        recordFile.close();
+        std::cout << "Recorded " << recordedFrames << " frames of input" << std::endl;
+    }
+
+    // Frames come from path instead of the window, session gets the settings it was recorded with.
+    // Check session.pileHash against the game before playing any of them.
+    bool StartReplay(const std::string& path, InputSession& session) {
+        replayFile.open(path, std::ios::binary);
+        if (!replayFile) {
+            std::cout << "Error: could not open input recording " << path << std::endl;
+            return false;
+        }
+
+        uint32_t magic = 0, version = 0;
+        Read(replayFile, magic);
+        Read(replayFile, version);
+        Read(replayFile, session.prizeCount);
+        Read(replayFile, session.stepTime);
+        Read(replayFile, session.pileHash);
+        if (!replayFile || magic != fileMagic || version != fileVersion) {
+            std::cout << "Error: " << path << " is not an input recording (or an old one)" << std::endl;
+            replayFile.close();
+            return false;
+        }
+
+        replaying = true;
+        replayFinished = false;
+        std::cout << "Replaying input from " << path << std::endl;
+        return true;
+    }
+
+    bool IsRecording() const { return recordFile.is_open(); }
+    bool IsReplaying() const { return replaying; }
+    bool ReplayFinished() const { return replayFinished; }
+
+    // Call once at the start of every frame. Live: samples the window, deltaTime is the real frame time.
+    // Replay: loads the next recorded frame, deltaTime comes from the recording.
+    void BeginFrame(GLFWwindow* window, double deltaTime) {
+        previous = current;
+
+        if (replaying) {
+            if (!replayFile.read(reinterpret_cast<char*>(&current), sizeof(current))) {
+                // Out of frames, nothing is held anymore
+                current = InputFrame();
+                current.deltaTime = static_cast<float>(deltaTime);
+                replayFinished = true;
+            }
+        }
+        else {
+            current = InputFrame();
+            current.deltaTime = static_cast<float>(deltaTime);
+            for (int key = 0; key < static_cast<int>(InputKey::Count); key++) {
+                if (glfwGetKey(window, GlfwKey(key)) == GLFW_PRESS) {
+                    current.keys |= 1u << key;
+                }
+            }
+            current.mouseX = pendingMouseX;
+            current.mouseY = pendingMouseY;
+            current.mouseMoved = pendingMouseMoved ? 1 : 0;
+            current.scroll = pendingScroll;
+        }
+
+        pendingMouseMoved = false;
+        pendingScroll = 0.0f;
+
+        if (recordFile.is_open()) {
+            recordFile.write(reinterpret_cast<const char*>(&current), sizeof(current));
+            recordedFrames++;
+        }
+    }
+
+    // GLFW callbacks forward here, the values show up in the next BeginFrame
+    void OnCursor(double x, double y) {
+        pendingMouseX = static_cast<float>(x);
+        pendingMouseY = static_cast<float>(y);
+        pendingMouseMoved = true;
+    }
+
+    void OnScroll(double yOffset) {
+        pendingScroll += static_cast<float>(yOffset);
+    }
+
+    bool IsDown(InputKey key) const {
+        return (current.keys & Bit(key)) != 0;
+    }
+
+    // Went down this frame
+    bool WasPressed(InputKey key) const {
+        return (current.keys & Bit(key)) != 0 && (previous.keys & Bit(key)) == 0;
+    }
+
+    double GetDeltaTime() const { return current.deltaTime; }
+    bool MouseMoved() const { return current.mouseMoved != 0; }
+    glm::vec2 GetMouse() const { return glm::vec2(current.mouseX, current.mouseY); }
+    float GetScroll() const { return current.scroll; }
+
+private:
+    enum : uint32_t {
+        fileMagic = 0x494E5031, // "INP1"
+        fileVersion = 2
+    };
+
+    InputFrame current;
+    InputFrame previous;
+
+    float pendingMouseX = 0.0f;
+    float pendingMouseY = 0.0f;
+    bool pendingMouseMoved = false;
+    float pendingScroll = 0.0f;
+
+    std::ofstream recordFile;
+    size_t recordedFrames = 0;
+
+    std::ifstream replayFile;
+    bool replaying = false;
+    bool replayFinished = false;
+
+    template <typename T>
+    static void Write(std::ofstream& file, const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    static void Read(std::ifstream& file, T& value) {
+        file.read(reinterpret_cast<char*>(&value), sizeof(value));
+    }
+
+    static uint32_t Bit(InputKey key) {
+        return 1u << static_cast<int>(key);
+    }
+
+    static int GlfwKey(int key) {
+        // Indexed by InputKey
+        static const int keys[static_cast<int>(InputKey::Count)] = {
+            GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D,
+            GLFW_KEY_E, GLFW_KEY_C, GLFW_KEY_F, GLFW_KEY_G,
+            GLFW_KEY_SPACE, GLFW_KEY_ESCAPE,
+            GLFW_KEY_LEFT, GLFW_KEY_RIGHT, GLFW_KEY_UP, GLFW_KEY_DOWN,
+            GLFW_KEY_Z, GLFW_KEY_O, GLFW_KEY_T, GLFW_KEY_P
+        };
+        return keys[key];
+    }
+};
+
+#endif // INPUT_HPP
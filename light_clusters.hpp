@@ -0,0 +1,145 @@
+#ifndef LIGHT_CLUSTERS_HPP
+#define LIGHT_CLUSTERS_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "cluster_grid.hpp"
+#include "ecs.hpp"
+#include "shader_variants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Clustered forward lighting. The view frustum is cut into a grid of clusters (screen tiles times depth
+// slices, the slices getting deeper with distance) and every frame each light is added to the clusters its
+// sphere touches, on the CPU by a ClusterGrid. The lights, each cluster's range in the index list and the index list go to
+// the GPU as texture buffers; basic.frag (CLUSTERED_LIGHTS) finds its cluster and loops over just those.
+class LightClusters {
+public:
+    static const int tilesX = ClusterGrid::tilesX;
+    static const int tilesY = ClusterGrid::tilesY;
+    static const int slices = ClusterGrid::slices;
+
+    // Texture units the buffers are bound to, above the ones meshes use for their maps
+    static const int lightDataUnit = 8;
+    static const int clusterGridUnit = 9;
+    static const int lightIndexUnit = 10;
+
+    // More than this and the furthest ones are dropped
+    size_t maxLights = 4096;
+
+    LightClusters() {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+
+        const GLenum formats[] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+        for (int i = 0; i < 3; i++) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    ~LightClusters() {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+
+    LightClusters(const LightClusters&) = delete;
+    LightClusters& operator=(const LightClusters&) = delete;
+
+    // Samplers and grid constants that don't change between frames
+    void SetUniforms(ShaderVariants& shaders, float nearPlane, float farPlane) {
+        shaders.setInt("uLightData", lightDataUnit);
+        shaders.setInt("uClusterGrid", clusterGridUnit);
+        shaders.setInt("uLightIndices", lightIndexUnit);
+        shaders.setVec3("uClusterCount", static_cast<float>(tilesX), static_cast<float>(tilesY), static_cast<float>(slices));
+
+        // slice = log(depth) * scale + bias, so slice 0 starts at the near plane and the last ends at the far one
+        float logRatio = std::log(farPlane / nearPlane);
+        shaders.setFloat("uSliceScale", slices / logRatio);
+        shaders.setFloat("uSliceBias", -slices * std::log(nearPlane) / logRatio);
+        grid.SetPlanes(nearPlane, farPlane);
+    }
+
+    // Assigns the lights to clusters for this frame's camera and uploads everything. The projection must be
+    // a perspective one with the near/far planes given to SetUniforms.
+    void Update(ShaderVariants& shaders, const std::vector<LightItem>& lights, const glm::mat4& view,
+                const glm::mat4& projection, int framebufferWidth, int framebufferHeight) {
+        shaders.setVec2("uTileSize", glm::vec2(std::max(framebufferWidth, 1) / static_cast<float>(tilesX),
+                                               std::max(framebufferHeight, 1) / static_cast<float>(tilesY)));
+
+        // Closest lights first if there are too many
+        const std::vector<LightItem>* used = &lights;
+        if (lights.size() > maxLights) {
+            sorted = lights;
+            glm::vec3 eye = glm::vec3(glm::inverse(view)[3]);
+            std::nth_element(sorted.begin(), sorted.begin() + maxLights, sorted.end(),
+                [&eye](const LightItem& a, const LightItem& b) {
+                    glm::vec3 da = a.position - eye, db = b.position - eye;
+                    return glm::dot(da, da) < glm::dot(db, db);
+                });
+            sorted.resize(maxLights);
+            used = &sorted;
+        }
+
+        grid.Assign(*used, view, projection);
+
+        // Three texels per light: position + radius, color + spot cosine, spot direction
+        lightData.resize(used->size() * 3);
+        for (size_t i = 0; i < used->size(); i++) {
+            const LightItem& light = (*used)[i];
+            lightData[i * 3] = glm::vec4(light.position, light.radius);
+            lightData[i * 3 + 1] = glm::vec4(light.color, light.spotCosine);
+            lightData[i * 3 + 2] = glm::vec4(light.direction, 0.0f);
+        }
+
+        Upload(0, lightData.data(), lightData.size() * sizeof(glm::vec4));
+        const std::vector<uint32_t>& clusterRanges = grid.GetClusterRanges();
+        const std::vector<uint32_t>& lightIndices = grid.GetLightIndices();
+        Upload(1, clusterRanges.data(), clusterRanges.size() * sizeof(uint32_t));
+        Upload(2, lightIndices.data(), lightIndices.size() * sizeof(uint32_t));
+
+        lightCount = used->size();
+    }
+
+    // Before drawing with a CLUSTERED_LIGHTS variant
+    void Bind() const {
+        const int units[] = { lightDataUnit, clusterGridUnit, lightIndexUnit };
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + units[i]);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t GetLightCount() const { return lightCount; }
+    size_t GetVisibleLightCount() const { return grid.GetAssignedLightCount(); } // Touching at least one cluster
+    size_t GetIndexCount() const { return grid.GetLightIndices().size(); }
+
+private:
+    ClusterGrid grid;
+    GLuint buffers[3];
+    GLuint textures[3];
+
+    std::vector<LightItem> sorted;
+    std::vector<glm::vec4> lightData;
+    size_t lightCount = 0;
+
+    void Upload(int buffer, const void* data, size_t size) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[buffer]);
+        // Orphan last frame's storage instead of waiting for the GPU to be done with it
+        glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(size, 16), NULL, GL_STREAM_DRAW);
+        if (size > 0) {
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif // LIGHT_CLUSTERS_HPP
@@ -0,0 +1,55 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+// Console output from the simulation side. Every message is built first and printed as one line under a
+// mutex, so machines set up in parallel (ClawMachineBatch) don't interleave. Info and warnings (what got
+// loaded, settled, restored) can be switched off for batch runs, errors always print.
+class Log {
+public:
+    static void SetEnabled(bool enabled) { EnabledFlag().store(enabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return EnabledFlag().load(std::memory_order_relaxed); }
+
+    template <typename... Args>
+    static void Info(const Args&... args) {
+        if (IsEnabled()) Print("", args...);
+    }
+
+    template <typename... Args>
+    static void Warning(const Args&... args) {
+        if (IsEnabled()) Print("Warning: ", args...);
+    }
+
+    template <typename... Args>
+    static void Error(const Args&... args) {
+        Print("Error: ", args...);
+    }
+
+private:
+    static std::atomic<bool>& EnabledFlag() {
+        static std::atomic<bool> enabled(true);
+        return enabled;
+    }
+
+    static std::mutex& OutputMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    template <typename... Args>
+    static void Print(const char* prefix, const Args&... args) {
+        std::ostringstream line;
+        line << prefix;
+        int expand[] = { 0, ((void)(line << args), 0)... };
+        (void)expand;
+
+        std::lock_guard<std::mutex> lock(OutputMutex());
+        std::cout << line.str() << std::endl;
+    }
+};
+
+#endif // LOG_HPP
@@ -0,0 +1,186 @@
+#ifndef MACHINE_BATCH_HPP
+#define MACHINE_BATCH_HPP
+
+#include <glm/glm.hpp>
+#include <reactphysics3d/reactphysics3d.h>
+#include "claw_game.hpp"
+#include "log.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Plays a claw machine like a (not very smart) player: starts a game, steers in a random direction for a
+// random time, drops, and lets go of whatever it caught once the claw is back up. Seeded, so a machine
+// plays the same games every run no matter which thread steps it.
+class ClawBot {
+public:
+    explicit ClawBot(unsigned int seed) : random(seed) {}
+
+    ClawCommand NextCommand(const ClawGame& game) {
+        ClawCommand command = {};
+        command.cameraPosition = glm::vec3(0.0f, 0.0f, 5.0f); // Out of reach of the pile, no direct pickups
+
+        if (!game.IsGameStarted()) {
+            command.interact = true;
+            command.lookingAtMachine = true;
+            PlanMove();
+        }
+        else if (game.IsClawMoving()) {
+            // Wait for the claw to come back up
+        }
+        else if (game.IsCarryingBirb()) {
+            command.drop = true; // Let go, ends the game
+        }
+        else if (moveSteps > 0) {
+            command.move = moveDirection;
+            moveSteps--;
+        }
+        else {
+            command.drop = true;
+        }
+        return command;
+    }
+
+private:
+    std::mt19937 random;
+    glm::vec2 moveDirection = glm::vec2(0.0f);
+    int moveSteps = 0;
+
+    void PlanMove() {
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        std::uniform_int_distribution<int> steps(0, 60);
+        float a = angle(random);
+        moveDirection = glm::vec2(std::cos(a), std::sin(a));
+        moveSteps = steps(random);
+    }
+};
+
+// Counters of one machine
+struct MachineResult {
+    int gamesPlayed = 0;
+    int clawPickups = 0;
+    double stepSeconds = 0.0; // Wall time spent stepping this machine
+};
+
+// Everything summed up over the batch
+struct BatchResults {
+    size_t machines = 0;
+    long long machineSteps = 0;   // Steps over all machines
+    double simulatedSeconds = 0.0; // Per machine
+    double wallSeconds = 0.0;      // Spent in Step
+    int gamesPlayed = 0;
+    int clawPickups = 0;
+    double payoutRate = 0.0;    // Pickups per game over the whole batch
+    double minPayoutRate = 0.0; // Worst and best single machine
+    double maxPayoutRate = 0.0;
+};
+
+// Many independent claw machines, each with its own PhysicsCommon and world (rp3d's allocators aren't
+// thread safe, so nothing is shared), played by ClawBots and stepped in parallel on a ThreadPool.
+class ClawMachineBatch {
+public:
+    ClawMachineBatch(size_t count, const ClawGameSettings& settings, ThreadPool& pool, unsigned int seed = 1)
+        : pool(pool) {
+        machines.resize(count);
+        if (count == 0) return;
+
+        // First one alone: it settles the pile and writes the cache if there isn't one yet,
+        // the rest just restore it, quietly (the same setup messages a thousand times over)
+        machines[0].reset(new Machine(settings, seed));
+        bool logEnabled = Log::IsEnabled();
+        Log::SetEnabled(false);
+        pool.ParallelFor(count - 1, [&](size_t i) {
+            machines[i + 1].reset(new Machine(settings, seed + static_cast<unsigned int>(i + 1)));
+        });
+        Log::SetEnabled(logEnabled);
+    }
+
+    ClawMachineBatch(const ClawMachineBatch&) = delete;
+    ClawMachineBatch& operator=(const ClawMachineBatch&) = delete;
+
+    // Advances every machine by steps fixed steps. Each task runs all steps of one machine, so threads only
+    // sync once per call; machines that take longer get balanced out by stealing.
+    void Step(double deltaTime, int steps = 1) {
+        typedef std::chrono::steady_clock BatchClock;
+        BatchClock::time_point start = BatchClock::now();
+
+        pool.ParallelFor(machines.size(), [&](size_t i) {
+            Machine& machine = *machines[i];
+            BatchClock::time_point machineStart = BatchClock::now();
+            for (int step = 0; step < steps; step++) {
+                machine.game->Step(machine.bot.NextCommand(*machine.game), deltaTime);
+            }
+            machine.stepSeconds += std::chrono::duration<double>(BatchClock::now() - machineStart).count();
+        });
+
+        stepsTaken += steps;
+        simulatedSeconds += steps * deltaTime;
+        wallSeconds += std::chrono::duration<double>(BatchClock::now() - start).count();
+    }
+
+    size_t GetMachineCount() const { return machines.size(); }
+    ClawGame& GetMachine(size_t i) { return *machines[i]->game; }
+
+    MachineResult GetMachineResult(size_t i) const {
+        const Machine& machine = *machines[i];
+        MachineResult result;
+        result.gamesPlayed = machine.game->GetGamesPlayed();
+        result.clawPickups = machine.game->GetClawPickups();
+        result.stepSeconds = machine.stepSeconds;
+        return result;
+    }
+
+    BatchResults Aggregate() const {
+        BatchResults results;
+        results.machines = machines.size();
+        results.machineSteps = stepsTaken * static_cast<long long>(machines.size());
+        results.simulatedSeconds = simulatedSeconds;
+        results.wallSeconds = wallSeconds;
+
+        bool first = true;
+        for (size_t i = 0; i < machines.size(); i++) {
+            MachineResult machine = GetMachineResult(i);
+            results.gamesPlayed += machine.gamesPlayed;
+            results.clawPickups += machine.clawPickups;
+
+            if (machine.gamesPlayed == 0) continue;
+            double payout = static_cast<double>(machine.clawPickups) / machine.gamesPlayed;
+            results.minPayoutRate = first ? payout : std::min(results.minPayoutRate, payout);
+            results.maxPayoutRate = first ? payout : std::max(results.maxPayoutRate, payout);
+            first = false;
+        }
+
+        if (results.gamesPlayed > 0) {
+            results.payoutRate = static_cast<double>(results.clawPickups) / results.gamesPlayed;
+        }
+        return results;
+    }
+
+private:
+    struct Machine {
+        // Declared first so it outlives the game's world
+        rp3d::PhysicsCommon physicsCommon;
+        std::unique_ptr<ClawGame> game;
+        ClawBot bot;
+        double stepSeconds = 0.0;
+
+        Machine(const ClawGameSettings& settings, unsigned int seed) : bot(seed) {
+            ClawGameSettings machineSettings = settings;
+            machineSettings.logEvents = false;
+            game.reset(new ClawGame(physicsCommon, machineSettings));
+        }
+    };
+
+    ThreadPool& pool;
+    std::vector<std::unique_ptr<Machine>> machines; // Separate allocations, machines on different threads don't share cache lines
+    long long stepsTaken = 0;
+    double simulatedSeconds = 0.0;
+    double wallSeconds = 0.0;
+};
+
+#endif // MACHINE_BATCH_HPP
@@ -1,15 +1,18 @@
 #pragma once
 #define _CRT_SECURE_NO_WARNINGS
+#ifdef _MSC_VER
 #pragma comment(lib, "opengl32.lib") // Added so Rider will stop complaining
+#endif
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <vector>
 #include <thread>
 #include <chrono>
-#include <set>
-#include <windows.h>
+#include <string>
+#include <cstdlib>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -19,66 +22,115 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <reactphysics3d/reactphysics3d.h>
-#include "gameobject.hpp"
+#include "claw_game.hpp"
+#include "physics_thread.hpp"
 #include "Camera.hpp"
+#include "input.hpp"
+#include "light_clusters.hpp"
+#include "occlusion_culler.hpp"
+#include "scene_renderer.hpp"
 #include "shader.hpp"
+#include "shader_reloader.hpp"
+#include "shader_variants.hpp"
+#include "shadow_map.hpp"
 #include "ui.hpp"
+#include "weighted_oit.hpp"
 
 const unsigned int wWidth = 800;
 const unsigned int wHeight = 600;
 
-#define GROUND_HEIGHT 0.2f
-
-GameObject* claw;
-GameObject* claw_machine;
-GameObject* ground;
-GameObject* colliders[9];
-GameObject* trigger;
-GameObject* lightCube;
-
-std::vector<GameObject*> birbs; 
-std::set<GameObject*> collectedBirbs;
+// Prizes in the pile, can be overridden with --prizes N
+int prizeCount = 20;
 
 // Physics objects
 rp3d::PhysicsCommon physicsCommon;
-rp3d::PhysicsWorld* physicsWorld = nullptr;
+PhysicsThread physicsThread(60.0);
+
+// The claw machine and its rules (owned by the physics thread, the render thread only sees FrameSnapshot)
+ClawGame* game = nullptr;
+
+// Models for the scene's model ids, render thread only
+SceneRenderer sceneRenderer;
+
+// Keyboard and mouse, live or replayed (--record FILE / --replay FILE)
+Input input;
+
+// Input sampled on the render thread, consumed by the physics thread
+SpscQueue<ClawCommand, 256> clawCommands;
+
+// Everything the render thread needs from a physics step
+struct FrameSnapshot {
+    std::vector<DrawItem> items;
+    std::vector<LightItem> lights;
+    bool gameStarted = false;
+    int birbsCollected = 0;
+    int transformsSynced = 0; // Objects whose transform actually changed this step
+};
+SnapshotBuffer<FrameSnapshot> frameSnapshots;
 
 // Camera
 Camera* camera = nullptr;
 
 // UI
+UIBatch* uiBatch = nullptr;
 Logo* logo = nullptr;
 Logo* birbIcon = nullptr;
-
-// Game state
-bool GameStarted = false;
+Font* hudFont = nullptr;     // Birb counter
+Font* overlayFont = nullptr; // Perf overlay
 
 // Depth buffer and backface culling state
 bool depthTestEnabled = true;
 bool backfaceCullingEnabled = false;
+bool depthPrepassEnabled = true; // Depth-only pass first, so lighting runs once per visible pixel
+bool occlusionCullingEnabled = true; // Skip prizes that last frame's occlusion queries found covered
+bool weightedOITEnabled = false; // Weighted blended transparency instead of sorting the blended meshes
+bool perfOverlayEnabled = true;
 
-// Claw movement speed
-float clawSpeed = 5.0f;
-
-// Claw movement state
-bool shouldMoveDown = false;
-bool shouldMoveUp = false;
-bool hasToy = false;
-glm::vec3 originalPosition;
-bool canMoveByKeys = true;
-GameObject* pickedUpBirb = nullptr; // Track which birb is picked up
-int birbsCollected = 0; // Track how many birbs collected
-
-void InitializeGameObjects();
-void MoveClaw(GLFWwindow* window, double deltaTime);
+void StepSimulation(double deltaTime);
+void PublishSnapshot();
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-GameObject* CheckTriggerCollision(); // Returns the birb that collided
-GameObject* CanDirectPickupBirb(); // Returns the birb that can be picked up
-void UpdateBirbPhysics();
 
-int main()
+int main(int argc, char** argv)
 {
+    std::string recordPath;
+    std::string replayPath;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--prizes")
+        {
+            prizeCount = std::max(0, std::atoi(argv[i + 1]));
+        }
+        else if (arg == "--record")
+        {
+            recordPath = argv[i + 1];
+        }
+        else if (arg == "--replay")
+        {
+            replayPath = argv[i + 1];
+        }
+    }
+
+    // A replay runs on the scene it was recorded with. Recording starts once the game is set up, the
+    // session needs the pile's hash.
+    InputSession session;
+    session.prizeCount = prizeCount;
+    session.stepTime = physicsThread.GetStepTime();
+    if (!replayPath.empty())
+    {
+        if (!input.StartReplay(replayPath, session))
+        {
+            return -4;
+        }
+        prizeCount = session.prizeCount;
+    }
+
+    // Recording or replaying steps the simulation on this thread from the frame times, instead of on
+    // the physics thread against the wall clock. Same frames in, same steps with the same input out.
+    bool lockstep = input.IsReplaying() || !recordPath.empty();
+    double stepAccumulator = 0.0;
+
     // ------------------------- INIT -------------------------
     if (!glfwInit())
     {
@@ -118,26 +170,69 @@ int main()
         return -3;
     }
 
-    // Create physics world
-    rp3d::PhysicsWorld::WorldSettings settings;
-    settings.gravity = rp3d::Vector3(0.0f, -9.81f, 0.0f);
-    physicsWorld = physicsCommon.createPhysicsWorld(settings);
+    // Physics world and scene
+    ClawGameSettings gameSettings;
+    gameSettings.prizeCount = prizeCount;
+    game = new ClawGame(physicsCommon, gameSettings);
 
-    InitializeGameObjects();
+    if (lockstep)
+    {
+        // Settling leaves contacts behind in the physics world that a restored pile doesn't have, so
+        // recording and replay both start from the cached pile, whichever launch settled it
+        if (!game->IsPileRestored())
+        {
+            delete game;
+            game = new ClawGame(physicsCommon, gameSettings);
+        }
+
+        if (input.IsReplaying() && session.pileHash != game->GetPileHash())
+        {
+            std::cout << "Error: " << replayPath << " was recorded on a different prize pile, can't replay it" << std::endl;
+            delete game;
+            glfwTerminate();
+            return -4;
+        }
+        else if (!recordPath.empty())
+        {
+            session.pileHash = game->GetPileHash();
+            input.StartRecording(recordPath, session);
+        }
+    }
 
     // Initialize camera
     camera = new Camera(glm::vec3(0.0f, 0.0f, 5.0f));
     camera->movementSpeed = 5.0f;
     camera->mouseSensitivity = 0.1f;
 
-    Shader unifiedShader("basic.vert", "basic.frag");
-    unifiedShader.use();
+    // One variant of basic.vert/basic.frag per kind of material, compiled as the models load
+    ShaderVariants unifiedShader("basic.vert", "basic.frag");
+    sceneRenderer.clusteredLights = true;
+    sceneRenderer.shadows = true;
+    sceneRenderer.LoadModels(game->GetScene(), unifiedShader);
+
+    // Bulbs, spotlights and glowing prizes on top of the main light
+    const float nearPlane = 0.1f;
+    const float farPlane = 100.0f;
+    LightClusters* lightClusters = new LightClusters();
+    lightClusters->SetUniforms(unifiedShader, nearPlane, farPlane);
+
+    // Position-only shader for the depth pre-pass, and the occlusion query boxes
+    Shader depthShader("depth.vert", "depth.frag");
+    OcclusionCuller* occlusionCuller = new OcclusionCuller();
+    std::vector<DrawItem> visibleItems;
+
+    // Top light's shadows, the machine and ground only redrawn into it when something there changes
+    const glm::vec3 topLightPosition(0.0f, 5.0f, 0.0f);
+    ShadowMap* shadowMap = new ShadowMap();
+
+    // Single-pass alternative to sorting the glass
+    WeightedOIT* weightedOIT = new WeightedOIT();
     unifiedShader.setVec3("uLightPos", 0, 1, 3);
     unifiedShader.setVec3("uViewPos", camera->position.x, camera->position.y, camera->position.z);
     unifiedShader.setVec3("uLightColor", 1, 1, 1);
     unifiedShader.setVec3("uAmbientColor", 1, 1, 1);
 
-    glm::mat4 projection = glm::perspective(glm::radians(camera->zoom), (float)mode->width / (float)mode->height, 0.1f, 100.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(camera->zoom), (float)mode->width / (float)mode->height, nearPlane, farPlane);
     unifiedShader.setMat4("uP", projection);
 
     glEnable(GL_DEPTH_TEST);
@@ -145,13 +240,33 @@ int main()
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // --- LOGO SETUP ---
+    // --- UI SETUP --- every image goes into one atlas, all of it drawn in one call
+    uiBatch = new UIBatch();
+
     logo = new Logo();
-    logo->Initialize("Logo.png", "res");
+    logo->Initialize(*uiBatch, "Logo.png", "res");
 
     // --- BIRB ICON SETUP (Bottom Left Corner) ---
     birbIcon = new Logo();
-    birbIcon->Initialize("birb.png", "res", -0.95f, -0.9f, -0.7f, -0.65f);
+    birbIcon->Initialize(*uiBatch, "birb.png", "res", -0.95f, -0.9f, -0.7f, -0.65f);
+
+    // --- HUD TEXT --- glyphs are rasterized into the UI atlas here, once
+    hudFont = new Font();
+    hudFont->Load(*uiBatch, "res/DejaVuSansMono.ttf", 40.0f);
+    overlayFont = new Font();
+    overlayFont->Load(*uiBatch, "res/DejaVuSansMono.ttf", 16.0f);
+    TextLayout birbCounter;
+    int shownBirbs = -1;
+    TextLayout perfOverlay;
+
+    // Perf overlay numbers, averaged over half a second so they can be read
+    double perfTime = 0.0;
+    int perfFrames = 0;
+    double perfWorkMs = 0.0; // Frame time without the limiter's wait
+    int perfWorkFrames = 0;
+
+    // Recompiles shaders when their files change, so they can be tweaked while the game runs
+    ShaderReloader* shaderReloader = new ShaderReloader(window);
 
     // Disable vsync to allow custom frame rate
     glfwSwapInterval(0);
@@ -163,37 +278,63 @@ int main()
     const double targetFPS = 75.0;
     const double targetFrameTime = 1.0 / targetFPS;
 
-    // High-precision timing variables
-    LARGE_INTEGER frequency;
-    LARGE_INTEGER lastFrameTime;
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&lastFrameTime);
+    // High-precision timing variables (steady_clock is QueryPerformanceCounter on Windows)
+    typedef std::chrono::steady_clock FrameClock;
+    const FrameClock::duration targetFrameDuration =
+        std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(targetFrameTime));
+    FrameClock::time_point lastFrameTime = FrameClock::now();
+
+    // Physics and game rules run on their own thread from here on (unless in lockstep)
+    PublishSnapshot();
+    if (!lockstep)
+    {
+        physicsThread.Start(StepSimulation);
+    }
 
     // ------------------------- MAIN LOOP -------------------------
     while (!glfwWindowShouldClose(window))
     {
+        FrameClock::time_point frameStart = FrameClock::now();
         double timeNow = glfwGetTime();
         deltaTime = timeNow - timeLast;
         timeLast = timeNow;
 
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        // This frame's input, a replay also decides how long the frame was
+        input.BeginFrame(window, deltaTime);
+        deltaTime = input.GetDeltaTime();
+
+        // Shaders that finished recompiling since the last frame
+        shaderReloader->Apply();
+
+        // Latest finished physics step
+        const FrameSnapshot& frame = frameSnapshots.Acquire();
+
+        if (input.IsDown(InputKey::Escape) || input.ReplayFinished())
+        {
+            glfwSetWindowShouldClose(window, true);
+        }
+        // The real Escape key still gets out of a replay
+        if (input.IsReplaying() && glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         {
             glfwSetWindowShouldClose(window, true);
         }
 
+        if (input.MouseMoved())
+        {
+            camera->ProcessMouseMovement(input.GetMouse().x, input.GetMouse().y);
+        }
+        if (input.GetScroll() != 0.0f)
+        {
+            camera->ProcessMouseScroll(input.GetScroll());
+        }
+
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Toggle depth buffer with 'G' key
-        static bool gPressed = false;
-        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !gPressed)
+        if (input.WasPressed(InputKey::G))
         {
-            gPressed = true;
             depthTestEnabled = !depthTestEnabled;
         }
-        if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE)
-        {
-            gPressed = false;
-        }
         
         if (depthTestEnabled)
         {
@@ -205,16 +346,10 @@ int main()
         }
 
         // Toggle backface culling with 'F' key
-        static bool fPressed = false;
-        if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !fPressed)
+        if (input.WasPressed(InputKey::F))
         {
-            fPressed = true;
             backfaceCullingEnabled = !backfaceCullingEnabled;
         }
-        if (glfwGetKey(window, GLFW_KEY_F) == GLFW_RELEASE)
-        {
-            fPressed = false;
-        }
         
         if (backfaceCullingEnabled)
         {
@@ -227,37 +362,50 @@ int main()
             glDisable(GL_CULL_FACE);
         }
 
-        // Check for E key to start game when looking at claw machine
-        static bool ePressed = false;
-        if (!GameStarted && glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS && !ePressed)
-        {
-            ePressed = true;
-            
-            // Check for direct birb pickup first
-            GameObject* directPickupBirb = CanDirectPickupBirb();
-            if (directPickupBirb) {
-                // Pick up birb directly
-                pickedUpBirb = directPickupBirb;
-                pickedUpBirb->rigidBody->setType(rp3d::BodyType::KINEMATIC);
-                collectedBirbs.insert(directPickupBirb); // ADD THIS LINE
-                birbsCollected++;
-    
-                std::cout << "Birb picked up directly! Total collected: " << birbsCollected << std::endl;
-            }
-            else if (camera->IsLookingAt(claw_machine->position)) {
-                GameStarted = true;
-                std::cout << "Game Started!" << std::endl;
-            }
+        // Toggle the depth pre-pass with 'Z' key, to compare frame times with and without it
+        if (input.WasPressed(InputKey::Z))
+        {
+            depthPrepassEnabled = !depthPrepassEnabled;
+            std::cout << "Depth pre-pass " << (depthPrepassEnabled ? "on" : "off") << std::endl;
+        }
+
+        // Toggle occlusion culling of prizes with 'O' key
+        if (input.WasPressed(InputKey::O))
+        {
+            occlusionCullingEnabled = !occlusionCullingEnabled;
+            std::cout << "Occlusion culling " << (occlusionCullingEnabled ? "on" : "off") << std::endl;
+        }
+
+        // Toggle between sorted and weighted blended transparency with 'T' key
+        if (input.WasPressed(InputKey::T))
+        {
+            weightedOITEnabled = !weightedOITEnabled;
+            std::cout << (weightedOITEnabled ? "Weighted blended transparency" : "Sorted transparency") << std::endl;
+        }
+
+        // Toggle the perf overlay with 'P' key
+        if (input.WasPressed(InputKey::P))
+        {
+            perfOverlayEnabled = !perfOverlayEnabled;
         }
-        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_RELEASE)
+
+        // Gather this frame's input for the physics thread
+        ClawCommand command = {};
+        command.cameraPosition = camera->position;
+
+        // E picks up a birb in reach, or starts the game when looking at the claw machine
+        if (!frame.gameStarted && input.WasPressed(InputKey::E))
         {
-            ePressed = false;
+            command.interact = true;
+            command.lookingAtMachine = camera->IsLookingAt(game->GetMachinePosition());
         }
 
         // Camera movement (only when not in game)
-        if (!GameStarted)
+        if (!frame.gameStarted)
         {
-            camera->ProcessKeyboard(window, static_cast<float>(deltaTime));
+            camera->ProcessMovement(input.IsDown(InputKey::W), input.IsDown(InputKey::S),
+                                    input.IsDown(InputKey::A), input.IsDown(InputKey::D),
+                                    static_cast<float>(deltaTime));
         }
 
         // Arrow keys for orbital rotation around claw machine
@@ -265,39 +413,61 @@ int main()
         float horizontalOrbit = 0.0f;
         float verticalOrbit = 0.0f;
 
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+        if (input.IsDown(InputKey::Left))
         {
             horizontalOrbit = orbitSpeed * static_cast<float>(deltaTime);
         }
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+        if (input.IsDown(InputKey::Right))
         {
             horizontalOrbit = -orbitSpeed * static_cast<float>(deltaTime);
         }
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+        if (input.IsDown(InputKey::Up))
         {
             verticalOrbit = orbitSpeed * static_cast<float>(deltaTime);
         }
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        if (input.IsDown(InputKey::Down))
         {
             verticalOrbit = -orbitSpeed * static_cast<float>(deltaTime);
         }
 
         if (horizontalOrbit != 0.0f || verticalOrbit != 0.0f)
         {
-            camera->OrbitAroundTarget(claw_machine->position, horizontalOrbit, verticalOrbit);
+            camera->OrbitAroundTarget(game->GetMachinePosition(), horizontalOrbit, verticalOrbit);
+        }
+
+        // WASD moves the claw while in game
+        if (input.IsDown(InputKey::W)) command.move.y -= 1.0f;
+        if (input.IsDown(InputKey::S)) command.move.y += 1.0f;
+        if (input.IsDown(InputKey::A)) command.move.x -= 1.0f;
+        if (input.IsDown(InputKey::D)) command.move.x += 1.0f;
+
+        // Space drops the claw, or lets go of a carried birb
+        if (frame.gameStarted && input.WasPressed(InputKey::Space))
+        {
+            command.drop = true;
+        }
+
+        clawCommands.Push(command);
+
+        // Lockstep: as many fixed steps as fit in this frame's time
+        if (lockstep)
+        {
+            stepAccumulator += deltaTime;
+            while (stepAccumulator >= session.stepTime)
+            {
+                StepSimulation(session.stepTime);
+                stepAccumulator -= session.stepTime;
+            }
         }
 
         // Update view position for lighting
         unifiedShader.setVec3("uViewPos", camera->position.x, camera->position.y, camera->position.z);
 
-        // Update light position to light cube location
-        unifiedShader.setVec3("uLightPos", 0.0f, 5.0f, 0.0f);
-        
-        // Set light type to point (0) for top light
-        unifiedShader.setInt("uLightType", 0);
+        // Point light at the top
+        unifiedShader.setVec3("uLightPos", topLightPosition);
 
         // Update light color based on game state
-        if (GameStarted) {
+        if (frame.gameStarted) {
             unifiedShader.setVec3("uLightColor", 0.0f, 1.0f, 0.0f);
         } else {
             unifiedShader.setVec3("uLightColor", 1.0f, 0.2f, 0.6f); // Pink
@@ -308,436 +478,180 @@ int main()
         unifiedShader.setMat4("uV", view);
 
         // Update projection with current zoom
-        projection = glm::perspective(glm::radians(camera->zoom), (float)mode->width / (float)mode->height, 0.1f, 100.0f);
+        projection = glm::perspective(glm::radians(camera->zoom), (float)mode->width / (float)mode->height, nearPlane, farPlane);
         unifiedShader.setMat4("uP", projection);
-
-        MoveClaw(window, deltaTime);
-
-        // Handle Space key for claw movement 
-        static bool spacePressed = false; 
-        if (GameStarted && glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !spacePressed && !shouldMoveDown && !shouldMoveUp)
-        {
-            spacePressed = true;
-    
-            if (pickedUpBirb) {
-                // Drop the birb
-                claw->RemoveChild(pickedUpBirb);
-                
-                // Calculate birb's current world position from parent transform
-                glm::mat4 birbWorldTransform = claw->GetTransform() * pickedUpBirb->GetTransform();
-                glm::vec3 dropPosition = glm::vec3(birbWorldTransform[3]);
-                dropPosition.y -= 0.2f;
-                
-                // Reset birb's transform components to world position
-                pickedUpBirb->position = dropPosition;
-                pickedUpBirb->rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-                pickedUpBirb->scale = glm::vec3(0.4f, 0.4f, 0.4f);
-                
-                // Rebuild transform matrix
-                pickedUpBirb->transform = glm::mat4(1.0f);
-                pickedUpBirb->transform = glm::translate(pickedUpBirb->transform, pickedUpBirb->position);
-                pickedUpBirb->transform = glm::scale(pickedUpBirb->transform, pickedUpBirb->scale);
-                
-                // Re-enable dynamic physics so it falls
-                pickedUpBirb->rigidBody->setType(rp3d::BodyType::DYNAMIC);
-                pickedUpBirb->SyncPhysicsFromTransform();
-                
-                pickedUpBirb = nullptr;
         
-                // End game
-                GameStarted = false;
-                std::cout << "Birb dropped! Game ended." << std::endl;
-            } else {
-                // Normal claw descent
-                shouldMoveDown = true;
-                canMoveByKeys = false;
-                originalPosition = claw->position;
-            }
-        }
-
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE)
+        // Toggle crouch with 'C' key
+        if (input.WasPressed(InputKey::C))
         {
-            spacePressed = false;
+            camera->ToggleCrouch();
+            std::cout << (camera->isCrouching ? "Crouching" : "Standing") << std::endl;
         }
         
-        // Handle claw vertical movement
-        if (shouldMoveDown)
-        {
-            const float descentSpeed = 2.0f;
-            glm::vec3 movement(0.0f, -descentSpeed * static_cast<float>(deltaTime), 0.0f);
-            glm::vec3 oldPosition = claw->position;
-            glm::mat4 oldTransform = claw->GetTransform();
-                        
-            claw->Translate(movement);
-            
-            // Update birb physics if it's being carried
-            if (pickedUpBirb) {
-                UpdateBirbPhysics();
-            }
-            
-            // Check for collision with claw machine or ground
-            if (physicsWorld->testOverlap(claw->rigidBody, claw_machine->rigidBody) ||
-                physicsWorld->testOverlap(claw->rigidBody, ground->rigidBody))
-            {
-                // Collision detected, restore position and start moving up
-                claw->position = oldPosition;
-                claw->transform = oldTransform;
-                claw->SyncPhysicsFromTransform();
-                
-                shouldMoveDown = false;
-                shouldMoveUp = true;
-            }
+        // Sort this frame's small lights into the clusters of the view frustum
+        int framebufferWidth = 0, framebufferHeight = 0;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        lightClusters->Update(unifiedShader, frame.lights, view, projection, framebufferWidth, framebufferHeight);
+        lightClusters->Bind();
+
+        // Shadow casters are everything published, prizes hidden from the camera can still cast
+        shadowMap->Update(sceneRenderer, depthShader, frame.items, topLightPosition);
+        shadowMap->SetUniforms(unifiedShader);
+        shadowMap->Bind();
+
+        // Everything the last physics step published, minus prizes the occlusion queries found covered
+        bool occlusionCulling = occlusionCullingEnabled && depthTestEnabled;
+        const std::vector<DrawItem>* items = &frame.items;
+        if (occlusionCulling)
+        {
+            occlusionCuller->Filter(frame.items, visibleItems);
+            items = &visibleItems;
         }
-    
-        if (shouldMoveUp)
+
+        // Depth first if the pre-pass is on. New queries go in as soon as the depth buffer has the occluders.
+        bool depthPrepass = depthPrepassEnabled && depthTestEnabled;
+        int drawCalls = 0;
+        depthShader.use();
+        depthShader.setMat4("uV", view);
+        depthShader.setMat4("uP", projection);
+        if (depthPrepass)
         {
-            const float ascentSpeed = 3.0f;
-            glm::vec3 currentPos = claw->position;
-            glm::vec3 direction = glm::normalize(originalPosition - currentPos);
-            float distance = glm::distance(currentPos, originalPosition);
-            
-            if (distance > 0.1f)
+            drawCalls += sceneRenderer.DrawDepth(depthShader, *items, backfaceCullingEnabled);
+            if (occlusionCulling)
             {
-                glm::vec3 movement = direction * ascentSpeed * static_cast<float>(deltaTime);
-                if (glm::length(movement) > distance)
-                {
-                    movement = direction * distance;
-                }
-                claw->Translate(movement);
-                
-                // Update birb physics if it's being carried
-                if (pickedUpBirb) {
-                    UpdateBirbPhysics();
-                }
-            }
-            else
-            {
-                // Reached original position
-                claw->position = originalPosition;
-                claw->transform = glm::translate(glm::mat4(1.0f), originalPosition) * glm::scale(glm::mat4(1.0f), glm::vec3(0.4f, 0.4f, 0.4f));
-                claw->SyncPhysicsFromTransform();
-                
-                // Update birb one last time at final position
-                if (pickedUpBirb) {
-                    UpdateBirbPhysics();
-                }
-                
-                shouldMoveUp = false;
-                canMoveByKeys = true;
-                
-                // End game if birb was not picked up after one cycle
-                if (!pickedUpBirb) {
-                    GameStarted = false;
-                    std::cout << "Game ended - birb not picked up" << std::endl;
-                }
+                occlusionCuller->IssueQueries(depthShader, sceneRenderer, frame.items, camera->position);
             }
         }
-        
-        // Toggle crouch with 'C' key
-        static bool cPressed = false;
-        if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !cPressed)
+        drawCalls += sceneRenderer.Draw(unifiedShader, *items, backfaceCullingEnabled, depthPrepass);
+        if (occlusionCulling && !depthPrepass)
         {
-            cPressed = true;
-            camera->ToggleCrouch();
-            std::cout << (camera->isCrouching ? "Crouching" : "Standing") << std::endl;
+            occlusionCuller->IssueQueries(depthShader, sceneRenderer, frame.items, camera->position);
         }
-        if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE)
+
+        // Glass and other blended meshes last, over everything opaque
+        drawCalls += sceneRenderer.DrawTransparent(unifiedShader, *items, camera->position, backfaceCullingEnabled,
+                                                   weightedOITEnabled ? weightedOIT : nullptr, framebufferWidth, framebufferHeight);
+
+        // Draw UI Overlay. Text is only laid out again when it changes.
+        glm::vec2 pixelSize(2.0f / std::max(framebufferWidth, 1), 2.0f / std::max(framebufferHeight, 1));
+        logo->Render(*uiBatch);
+        birbIcon->Render(*uiBatch);
+        if (frame.birbsCollected != shownBirbs)
         {
-            cPressed = false;
-        }
-        
-        // Check for trigger collision and pick up birb
-        GameObject* collidedBirb = CheckTriggerCollision();
-        if (collidedBirb && !pickedUpBirb) {
-            // Reset birb scale to original
-            collidedBirb->Scale(glm::vec3(1.0f, 1.0f, 1.0f));
-    
-            claw->AddChild(collidedBirb);
-     
-            // Make birb kinematic so physics doesn't interfere while carried
-            collidedBirb->rigidBody->setType(rp3d::BodyType::KINEMATIC);
-     
-            pickedUpBirb = collidedBirb;
-            std::cout << "Birb picked up!" << std::endl;
-        }
-        
-        // Update birb physics to follow claw while picked up (for horizontal movement)
-        if (pickedUpBirb && canMoveByKeys) {
-            UpdateBirbPhysics();
-        }
-        
-        // Update physics simulation
-        physicsWorld->update(static_cast<rp3d::decimal>(deltaTime));
-        
-        // Update physics for all dynamic birbs (only when not picked up)
-        for (GameObject* birb : birbs) {
-            if (birb != pickedUpBirb && collectedBirbs.find(birb) == collectedBirbs.end()) {
-                birb->SyncTransformFromPhysics();
-            }
-        }
-        
-        // Draw
-        // Disable backface culling for claw_machine to prevent disappearing
-        if (backfaceCullingEnabled) {
-            glDisable(GL_CULL_FACE);
-        }
-        claw_machine->Draw(unifiedShader);
-        if (backfaceCullingEnabled) {
-            glEnable(GL_CULL_FACE);
-        }
-        claw->Draw(unifiedShader);
-        ground->Draw(unifiedShader); 
-        
-        // Draw all birbs that aren't picked up or collected
-        for (GameObject* birb : birbs) {
-            // Skip if birb has been collected
-            if (collectedBirbs.find(birb) != collectedBirbs.end()) {
-                continue;
-            }
-    
-            // Check if this birb is being carried by the claw
-            bool isBeingCarried = (birb == pickedUpBirb && claw->IsChild(birb));
-    
-            // Only draw if not being carried
-            if (!isBeingCarried) {
-                birb->Draw(unifiedShader);
-            }
+            birbCounter.Set(*hudFont, *uiBatch, "x " + std::to_string(frame.birbsCollected));
+            shownBirbs = frame.birbsCollected;
         }
+        birbCounter.Render(*uiBatch, glm::vec2(-0.68f, -0.85f), pixelSize);
 
-        // Draw UI Overlay
-        if (logo && logo->IsLoaded()) {
-            logo->Render();
-        }
-        
-        // Switch back to unified shader for 3D rendering
-        unifiedShader.use();
-        
-        
-        // Draw light cube with color based on game state
-        if (GameStarted) {
-            unifiedShader.setVec3("uDiffuseColor", 0.0f, 1.0f, 0.0f);
-        } else {
-            unifiedShader.setVec3("uDiffuseColor", 1.0f, 0.2f, 0.6f); // Pink
+        perfTime += deltaTime;
+        perfFrames++;
+        if (perfTime >= 0.5 || perfOverlay.GetText().empty())
+        {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(0) << perfFrames / std::max(perfTime, 1e-6) << " fps  "
+                 << std::setprecision(2) << perfWorkMs / std::max(perfWorkFrames, 1) << " ms\n"
+                 << drawCalls << " draw calls\n"
+                 << lightClusters->GetVisibleLightCount() << "/" << lightClusters->GetLightCount() << " lights\n"
+                 << occlusionCuller->GetHiddenCount() << "/" << occlusionCuller->GetTestedCount() << " prizes hidden\n"
+                 << shadowMap->GetCachedCasterCount() << " cached, " << shadowMap->GetDynamicCasterCount() << " moving shadow casters";
+            perfOverlay.Set(*overlayFont, *uiBatch, text.str());
+            perfTime = 0.0;
+            perfFrames = 0;
+            perfWorkMs = 0.0;
+            perfWorkFrames = 0;
+        }
+        if (perfOverlayEnabled)
+        {
+            perfOverlay.Render(*uiBatch, glm::vec2(-0.98f, 0.95f), pixelSize, glm::vec4(1.0f, 1.0f, 0.6f, 1.0f));
         }
-        
-        // Reset diffuse color to white for other objects
-        unifiedShader.setVec3("uDiffuseColor", 1.0f, 1.0f, 1.0f);
+        uiBatch->Draw();
+
 
         glfwSwapBuffers(window);
         glfwPollEvents();
 
         // High-precision frame limiter
-        LARGE_INTEGER currentTime;
-        QueryPerformanceCounter(&currentTime);
-        
-        double elapsed = static_cast<double>(currentTime.QuadPart - lastFrameTime.QuadPart) / frequency.QuadPart;
-        
-        if (elapsed < targetFrameTime)
+        FrameClock::time_point currentTime = FrameClock::now();
+        perfWorkMs += std::chrono::duration<double, std::milli>(currentTime - frameStart).count();
+        perfWorkFrames++;
+        FrameClock::time_point targetTime = lastFrameTime + targetFrameDuration;
+
+        while (currentTime < targetTime)
         {
-            LARGE_INTEGER targetTime;
-            targetTime.QuadPart = lastFrameTime.QuadPart + static_cast<long long>(targetFrameTime * frequency.QuadPart);
-            
-            while (currentTime.QuadPart < targetTime.QuadPart)
-            {
-                QueryPerformanceCounter(&currentTime);
-                if ((currentTime.QuadPart % 1000) == 0)
-                {
-                    std::this_thread::yield();
-                }
-            }
+            std::this_thread::yield();
+            currentTime = FrameClock::now();
         }
-        
+
         lastFrameTime = currentTime;
     }
 
     // Cleanup
-    physicsCommon.destroyPhysicsWorld(physicsWorld);
+    physicsThread.Stop();
+    input.StopRecording();
+    delete game;
     delete camera;
     delete logo;
     delete birbIcon;
-    delete claw;
-    delete claw_machine;
-    delete ground;
-    for (GameObject* birb : birbs) {
-        delete birb;
-    }
-    birbs.clear();
-    delete lightCube;
+    delete hudFont;
+    delete overlayFont;
+    delete uiBatch;
+    delete shaderReloader;
+    delete lightClusters;
+    delete occlusionCuller;
+    delete shadowMap;
+    delete weightedOIT;
     glfwTerminate();
     return 0;
 }
 
-void InitializeGameObjects()
+void StepSimulation(double deltaTime)
 {
-    // ==================== CLAW MACHINE ====================
-    claw_machine = new GameObject("res/claw_machine.obj", physicsWorld, rp3d::BodyType::STATIC);
-    claw_machine->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
-    claw_machine->Translate(glm::vec3(0.0f, GROUND_HEIGHT, 0.0f));
-    claw_machine->AddConcaveCollision(physicsCommon);
-
-    // ==================== GROUND ====================
-    ground = new GameObject("res/ground.obj", physicsWorld, rp3d::BodyType::STATIC);
-    ground->Translate(glm::vec3(0.0f, -2.0f, 0.0f));
-    ground->AddBoxCollision(physicsCommon, glm::vec3(10.0f, 0.5f, 10.0f));
-
-    // ==================== CLAW ====================
-    claw = new GameObject("res/claw.obj", physicsWorld, rp3d::BodyType::KINEMATIC);
-    claw->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
-    claw->Translate(glm::vec3(0.0f, 1.0f, 0.0f));
-    claw->AddBoxCollision(physicsCommon, glm::vec3(0.1f, 0.3f, 0.1f));
-    
-    // ==================== TRIGGER ====================
-    trigger = new GameObject("res/trigger.obj", physicsWorld, rp3d::BodyType::KINEMATIC);
-    trigger->AddSphereCollision(physicsCommon, 0.2f);
-    
-    //claw->AddChild(trigger);
-    
-    // ==================== BIRBS (Multiple) ====================
-    // Birb 1
-    GameObject* birb1 = new GameObject("res/birb.obj", physicsWorld, rp3d::BodyType::DYNAMIC);
-    birb1->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
-    birb1->Translate(glm::vec3(0.0f, -1.0f, 0.0f));
-    birb1->AddBoxCollision(physicsCommon, glm::vec3(0.12f, 0.12f, 0.12f));
-    birbs.push_back(birb1);
-    
-    // Birb 2
-    GameObject* birb2 = new GameObject("res/birb.obj", physicsWorld, rp3d::BodyType::DYNAMIC);
-    birb2->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
-    birb2->Translate(glm::vec3(0.5f, -1.0f, 0.5f)); // Different position
-    birb2->AddBoxCollision(physicsCommon, glm::vec3(0.12f, 0.12f, 0.12f));
-    birbs.push_back(birb2);
-    
-    // ==================== LIGHT CUBE ====================
-    lightCube = new GameObject("res/trigger.obj", physicsWorld, rp3d::BodyType::STATIC);
-    lightCube->Scale(glm::vec3(0.4f, 0.4f, 0.4f));
-    lightCube->Translate(glm::vec3(2.0f, 1.0f, 0.0f));
-}
-
-void MoveClaw(GLFWwindow* window, double deltaTime)
-{
-    if (!GameStarted || !canMoveByKeys) return;
-    
-    const float clawSpeed = 3.0f;
-    float dt = static_cast<float>(deltaTime);
-    
-    glm::vec3 oldPosition = claw->position;
-    glm::mat4 oldTransform = claw->GetTransform();
-                    
-    glm::vec3 movement(0.0f);
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-    {
-        movement.z -= clawSpeed * dt;
+    // Held input comes from the newest command, presses from any command since the last step
+    static ClawCommand step = {};
+    step.interact = false;
+    step.drop = false;
+
+    ClawCommand command;
+    while (clawCommands.Pop(command)) {
+        step.move = command.move;
+        if (command.interact) {
+            step.interact = true;
+            step.lookingAtMachine = command.lookingAtMachine;
+            step.cameraPosition = command.cameraPosition;
+        }
+        step.drop = step.drop || command.drop;
     }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-    {
-        movement.z += clawSpeed * dt;
-    }
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-    {
-        movement.x -= clawSpeed * dt;
-    }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-    {
-        movement.x += clawSpeed * dt;
-    }
-    
-    claw->Translate(movement);
-    
-    if (physicsWorld->testOverlap(claw->rigidBody, claw_machine->rigidBody))
-    {
-        claw->position = oldPosition;
-        claw->transform = oldTransform;
-        claw->SyncPhysicsFromTransform();
-    }
-}
 
-void mouse_callback(GLFWwindow* window, double xpos, double ypos)
-{
-    if (camera)
-    {
-        camera->ProcessMouseMovement(static_cast<float>(xpos), static_cast<float>(ypos));
-    }
-}
+    game->Step(step, deltaTime);
 
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
-{
-    if (camera)
-    {
-        camera->ProcessMouseScroll(static_cast<float>(yoffset));
-    }
+    PublishSnapshot();
 }
 
-GameObject* CheckTriggerCollision()
+void PublishSnapshot()
 {
-    if (!trigger || !claw || !trigger->rigidBody) return nullptr;
-    
-    // Get world position of trigger
-    glm::mat4 triggerWorldTransform = claw->GetTransform() * trigger->GetTransform();
-    glm::vec3 triggerWorldPos = glm::vec3(triggerWorldTransform[3]);
-    
-    // Check collision with all birbs
-    for (GameObject* birb : birbs) {
-        if (!birb || !birb->rigidBody) continue;
-        
-        // Get world position of birb
-        rp3d::Vector3 birbPos = birb->rigidBody->getTransform().getPosition();
-        glm::vec3 birbWorldPos = glm::vec3(birbPos.x, birbPos.y, birbPos.z);
-        
-        // Calculate distance between centers
-        float distance = glm::distance(triggerWorldPos, birbWorldPos);
-        
-        // Check if collision occurs
-        if (distance < 0.2f + 0.12f) {
-            return birb; // Return the first birb that collides
-        }
-    }
-    
-    return nullptr;
+    FrameSnapshot& frame = frameSnapshots.BeginWrite();
+    frame.items.clear();
+    frame.lights.clear();
+    frame.gameStarted = game->IsGameStarted();
+    frame.birbsCollected = game->GetBirbsCollected();
+    frame.transformsSynced = game->GetTransformsSynced();
+
+    // Dirty matrices get composed together in one SIMD batch, then everything visible is drawn
+    // (collected birbs are hidden, a carried one follows the claw through its parent)
+    TransformSystem::Update(game->GetScene());
+    RenderSystem::Gather(game->GetScene(), frame.items);
+    LightSystem::Gather(game->GetScene(), frame.lights);
+
+    frameSnapshots.Publish();
 }
 
-GameObject* CanDirectPickupBirb()
+// Mouse goes through Input so it can be recorded, the camera picks it up at the start of the next frame
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
-    if (!camera) return nullptr;
-    
-    glm::vec3 cameraPos = camera->position;
-    
-    // Check all birbs for proximity
-    for (GameObject* birb : birbs) {
-        if (!birb || !birb->rigidBody) continue;
-        
-        // Skip if this birb is already picked up
-        if (birb == pickedUpBirb) continue;
-        
-        glm::vec3 birbWorldPos = glm::vec3(
-            birb->rigidBody->getTransform().getPosition().x,
-            birb->rigidBody->getTransform().getPosition().y,
-            birb->rigidBody->getTransform().getPosition().z
-        );
-        
-        float distance = glm::distance(cameraPos, birbWorldPos);
-        if (distance < 2.0f) {
-            return birb; // Return the first birb within range
-        }
-    }
-    
-    return nullptr;
+    input.OnCursor(xpos, ypos);
 }
 
-void UpdateBirbPhysics()
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
-    if (!pickedUpBirb || !claw) return;
-    
-    // Calculate birb's world transform from parent-child hierarchy
-    glm::mat4 birbWorldTransform = claw->GetTransform() * pickedUpBirb->GetTransform();
-    
-    // Extract position and rotation from world transform
-    glm::vec3 worldPosition = glm::vec3(birbWorldTransform[3]);
-    glm::quat worldRotation = glm::quat_cast(birbWorldTransform);
-    
-    // Update birb's physics body to match visual position
-    rp3d::Vector3 rp3dPos(worldPosition.x, worldPosition.y, worldPosition.z);
-    rp3d::Quaternion rp3dRot(worldRotation.x, worldRotation.y, worldRotation.z, worldRotation.w);
-    rp3d::Transform physicsTransform(rp3dPos, rp3dRot);
-    
-    pickedUpBirb->rigidBody->setTransform(physicsTransform);
-}
\ No newline at end of file
+    input.OnScroll(yoffset);
+}
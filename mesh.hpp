@@ -9,6 +9,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "shader.hpp"
+#include "shader_variants.hpp"
 
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@ struct Texture {
     unsigned int id;
     string type;
     string path;
+    bool hasAlpha = false;
 };
 
 class Mesh {
@@ -37,6 +39,8 @@ public:
     vector<Texture>      textures;
     glm::vec3 diffuseColor;  // Added to handle Kd for textures
     float opacity;
+    ShaderPermutation permutation; // Material side (texture, alpha), the renderer picks the light type
+    glm::vec3 center = glm::vec3(0.0f); // Middle of the bounding box, blended meshes are sorted by it
     unsigned int VAO;
 
     // constructor
@@ -48,18 +52,37 @@ public:
         this->diffuseColor = diffuseColor;
         this->opacity = opacity;
 
+        // Pick the shader variant once here instead of branching per fragment
+        for (const Texture& texture : textures) {
+            if (texture.type != "uDiffMap") continue;
+            permutation.textured = true;
+            if (texture.hasAlpha)
+                permutation.alpha = AlphaMode::AlphaTested;
+            break;
+        }
+        if (opacity < 1.0f)
+            permutation.alpha = AlphaMode::Blended;
+
+        if (!vertices.empty()) {
+            glm::vec3 boundsMin = vertices[0].Position, boundsMax = vertices[0].Position;
+            for (const Vertex& vertex : vertices) {
+                boundsMin = glm::min(boundsMin, vertex.Position);
+                boundsMax = glm::max(boundsMax, vertex.Position);
+            }
+            center = (boundsMin + boundsMax) * 0.5f;
+        }
+
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
         setupMesh();
     }
 
-    // render the mesh
+    // render the mesh with the shader variant for its permutation (already bound)
     void Draw(Shader& shader)
     {
         // bind appropriate textures
         unsigned int diffuseNr = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr = 1;
-        bool hasTexture = false; // Track if we actually bound a texture
     
         for (unsigned int i = 0; i < textures.size(); i++)
         {
@@ -67,10 +90,8 @@ public:
             // retrieve texture number (the N in diffuse_textureN)
             string number;
             string name = textures[i].type;
-            if (name == "uDiffMap") {
+            if (name == "uDiffMap")
                 number = std::to_string(diffuseNr++);
-                hasTexture = true; // Mark that we have a texture
-            }
             else
                 number = std::to_string(specularNr++); // transfer unsigned int to string
 
@@ -80,10 +101,11 @@ public:
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
     
-        // Send material color and a flag to the shader
-        shader.setVec3("uDiffuseColor", diffuseColor);
-        shader.setInt("uHasTexture", hasTexture ? 1 : 0);
-        shader.setFloat("uOpacity", opacity);  
+        // Only what the variant reads: the color replaces a texture, opacity only matters when blending
+        if (!permutation.textured)
+            shader.setVec3("uDiffuseColor", diffuseColor);
+        if (permutation.alpha == AlphaMode::Blended)
+            shader.setFloat("uOpacity", opacity);
 
         // draw mesh
         glBindVertexArray(VAO);
@@ -94,6 +116,14 @@ public:
         glActiveTexture(GL_TEXTURE0);
     }
 
+    // Just the triangles, for depth-only passes (the shader only reads positions)
+    void DrawGeometry()
+    {
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(0);
+    }
+
     void UpdateVertexBuffer()
     {
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
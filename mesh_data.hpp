@@ -0,0 +1,61 @@
+#ifndef MESH_DATA_HPP
+#define MESH_DATA_HPP
+
+#include <glm/glm.hpp>
+#include "log.hpp"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <string>
+#include <vector>
+
+// Triangles of a model file without anything needed for drawing (no normals, textures or GL buffers).
+// This is what the simulation loads for mesh colliders, the renderer loads the full Model itself.
+struct MeshData {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices; // Three per triangle
+};
+
+// All meshes of the file merged into one, in the same order Model loads them
+inline bool LoadMeshData(const std::string& path, MeshData& out) {
+    out.positions.clear();
+    out.indices.clear();
+
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        Log::Error("ASSIMP: ", importer.GetErrorString());
+        return false;
+    }
+
+    std::vector<const aiNode*> nodes(1, scene->mRootNode);
+    while (!nodes.empty()) {
+        const aiNode* node = nodes.back();
+        nodes.pop_back();
+
+        for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+            const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+            unsigned int baseVertex = static_cast<unsigned int>(out.positions.size());
+
+            for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+                out.positions.push_back(glm::vec3(mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z));
+            }
+            for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+                const aiFace& face = mesh->mFaces[f];
+                for (unsigned int j = 0; j < face.mNumIndices; j++) {
+                    out.indices.push_back(baseVertex + face.mIndices[j]);
+                }
+            }
+        }
+
+        // Children pushed in reverse so they come off the stack in order, same as Model's recursion
+        for (unsigned int i = node->mNumChildren; i > 0; i--) {
+            nodes.push_back(node->mChildren[i - 1]);
+        }
+    }
+    return true;
+}
+
+#endif // MESH_DATA_HPP
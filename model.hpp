@@ -21,7 +21,6 @@
 #include <iostream>
 #include <map>
 #include <vector>
-#include <reactphysics3d/reactphysics3d.h>
 
 using namespace std;
 
@@ -35,6 +34,9 @@ public:
     vector<Mesh>    meshes;
     string directory;
     bool gammaCorrection;
+    // Bounding box of all meshes in model space (for occlusion queries)
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
 
     Model() {}
 
@@ -44,56 +46,6 @@ public:
         loadModel(path);
     }
 
-    // draws the model, but look out for transparency order
-    void Draw(Shader& shader)
-    {
-        // Draw opaque meshes first
-        for (unsigned int i = 0; i < meshes.size(); i++)
-        {
-            if(meshes[i].opacity >= 1.0f)  // Only opaque
-                meshes[i].Draw(shader);
-        }
-    
-        // Then draw transparent meshes (disable depth writing)
-        glDepthMask(GL_FALSE);
-        for (unsigned int i = 0; i < meshes.size(); i++)
-        {
-            if(meshes[i].opacity < 1.0f)  // Only transparent
-                meshes[i].Draw(shader);
-        }
-        glDepthMask(GL_TRUE);  // Re-enable depth writing
-    }
-    
-    // NEW - Extract mesh data for physics collision
-    void GetMeshDataForPhysics(std::vector<rp3d::Vector3>& outVertices, 
-                               std::vector<int>& outIndices, 
-                               glm::vec3 scale) {
-        outVertices.clear();
-        outIndices.clear();
-        
-        // Iterate through all meshes in the model
-        for (const auto& mesh : meshes) {
-            size_t baseVertex = outVertices.size();  // Fixed: use size_t instead of int
-            
-            // Add vertices with scale applied
-            for (const auto& vertex : mesh.vertices) {
-                outVertices.push_back(rp3d::Vector3(
-                    vertex.Position.x * scale.x,
-                    vertex.Position.y * scale.y,
-                    vertex.Position.z * scale.z
-                ));
-            }
-            
-            // Add indices (offset by base vertex for multiple meshes)
-            for (unsigned int index : mesh.indices) {
-                outIndices.push_back(static_cast<int>(baseVertex + index));  // Fixed: explicit cast
-            }
-        }
-        
-        std::cout << "  Extracted " << outVertices.size() << " vertices and " 
-                  << outIndices.size() / 3 << " triangles for physics" << std::endl;
-    }
-
 private:
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(string const& path)
@@ -116,6 +68,17 @@ private:
         }
 
         processNode(scene->mRootNode, scene);   
+
+        bool first = true;
+        for (const Mesh& mesh : meshes)
+        {
+            for (const Vertex& vertex : mesh.vertices)
+            {
+                boundsMin = first ? vertex.Position : glm::min(boundsMin, vertex.Position);
+                boundsMax = first ? vertex.Position : glm::max(boundsMax, vertex.Position);
+                first = false;
+            }
+        }
     }
 
     // processes a node in a recursive fashion
@@ -231,6 +194,11 @@ private:
                 texture.id = TextureFromFile(str.C_Str(), this->directory);
                 texture.type = typeName;
                 texture.path = str.C_Str();
+                // Decides whether meshes using it need the alpha-tested shader variant
+                GLint alphaBits = 0;
+                glBindTexture(GL_TEXTURE_2D, texture.id);
+                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_ALPHA_SIZE, &alphaBits);
+                texture.hasAlpha = alphaBits > 0;
                 textures.push_back(texture);
                 textures_loaded.push_back(texture);
             }
@@ -0,0 +1,137 @@
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Reference to a pooled object. The generation changes every time a slot is reused,
+// so a handle to a destroyed object never resolves to whatever took its place.
+struct Handle {
+    uint32_t index = 0xFFFFFFFF;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != 0xFFFFFFFF; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// Fixed-size slots in chunks of ChunkSize. Objects never move once created (pointers stay valid until
+// Destroy), neighbours sit next to each other in memory, and freed slots are reused before a new chunk
+// is allocated, so a warmed-up pool creates and destroys without touching the heap.
+template <typename T, size_t ChunkSize = 256>
+class ObjectPool {
+public:
+    explicit ObjectPool(size_t reserve = 0) {
+        while (capacity < reserve) {
+            AddChunk();
+        }
+    }
+
+    ~ObjectPool() {
+        Clear();
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    Handle Create(Args&&... args) {
+        if (freeSlots.empty()) {
+            AddChunk();
+        }
+
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+
+        Slot& slot = SlotAt(index);
+        new (slot.storage) T(std::forward<Args>(args)...);
+        slot.alive = true;
+        count++;
+
+        Handle handle;
+        handle.index = index;
+        handle.generation = slot.generation;
+        return handle;
+    }
+
+    void Destroy(Handle handle) {
+        T* object = Get(handle);
+        if (!object) return;
+
+        Slot& slot = SlotAt(handle.index);
+        object->~T();
+        slot.alive = false;
+        slot.generation++;
+        freeSlots.push_back(handle.index); // Never grows past capacity, reserved in AddChunk
+        count--;
+    }
+
+    // nullptr if the handle is stale or was never valid
+    T* Get(Handle handle) {
+        if (handle.index >= capacity) return nullptr;
+
+        Slot& slot = SlotAt(handle.index);
+        if (!slot.alive || slot.generation != handle.generation) return nullptr;
+        return reinterpret_cast<T*>(slot.storage);
+    }
+
+    // Destroys every live object, keeps the memory for reuse
+    void Clear() {
+        for (uint32_t index = 0; index < capacity; index++) {
+            Slot& slot = SlotAt(index);
+            if (!slot.alive) continue;
+
+            Handle handle;
+            handle.index = index;
+            handle.generation = slot.generation;
+            Destroy(handle);
+        }
+    }
+
+    // Visits live objects in memory order
+    template <typename Function>
+    void ForEach(Function function) {
+        for (uint32_t index = 0; index < capacity; index++) {
+            Slot& slot = SlotAt(index);
+            if (slot.alive) {
+                function(*reinterpret_cast<T*>(slot.storage));
+            }
+        }
+    }
+
+    size_t Count() const { return count; }
+    size_t Capacity() const { return capacity; }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    std::vector<uint32_t> freeSlots;
+    uint32_t capacity = 0;
+    size_t count = 0;
+
+    Slot& SlotAt(uint32_t index) {
+        return chunks[index / ChunkSize][index % ChunkSize];
+    }
+
+    void AddChunk() {
+        chunks.emplace_back(new Slot[ChunkSize]);
+        freeSlots.reserve(capacity + ChunkSize);
+
+        // Pushed in reverse so the lowest index comes out first
+        for (size_t i = ChunkSize; i > 0; i--) {
+            freeSlots.push_back(capacity + static_cast<uint32_t>(i - 1));
+        }
+        capacity += ChunkSize;
+    }
+};
+
+#endif // OBJECT_POOL_HPP
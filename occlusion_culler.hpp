@@ -0,0 +1,172 @@
+#ifndef OCCLUSION_CULLER_HPP
+#define OCCLUSION_CULLER_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "ecs.hpp"
+#include "scene_renderer.hpp"
+#include "shader.hpp"
+
+#include <vector>
+
+// Skips prizes that are covered (buried in the pile, behind the cabinet) using hardware occlusion queries.
+// Every occlusion-tested item gets its bounding box drawn against the frame's depth with a query around it;
+// the answer is read back a frame or more later, only once the GPU says it's available, so nothing ever waits
+// on it. Until an item's first answer comes in it counts as visible, and one that becomes visible shows up
+// a frame late.
+class OcclusionCuller {
+public:
+    OcclusionCuller() {
+        // Unit cube around the origin, positions only (location 0, like Vertex::Position)
+        const float corners[] = {
+            -0.5f, -0.5f, -0.5f,  0.5f, -0.5f, -0.5f,  0.5f,  0.5f, -0.5f, -0.5f,  0.5f, -0.5f,
+            -0.5f, -0.5f,  0.5f,  0.5f, -0.5f,  0.5f,  0.5f,  0.5f,  0.5f, -0.5f,  0.5f,  0.5f
+        };
+        const unsigned int faces[] = {
+            0, 1, 2, 2, 3, 0,  4, 6, 5, 6, 4, 7,  0, 3, 7, 7, 4, 0,
+            1, 5, 6, 6, 2, 1,  0, 4, 5, 5, 1, 0,  3, 2, 6, 6, 7, 3
+        };
+
+        glGenVertexArrays(1, &boxVAO);
+        glGenBuffers(1, &boxVBO);
+        glGenBuffers(1, &boxEBO);
+        glBindVertexArray(boxVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, boxEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(faces), faces, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glBindVertexArray(0);
+    }
+
+    ~OcclusionCuller() {
+        for (const ObjectQuery& object : objects) {
+            if (object.query) glDeleteQueries(1, &object.query);
+        }
+        glDeleteBuffers(1, &boxEBO);
+        glDeleteBuffers(1, &boxVBO);
+        glDeleteVertexArrays(1, &boxVAO);
+    }
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    // Picks up the query answers that have arrived and copies every item into visible except the ones
+    // an answer found hidden
+    void Filter(const std::vector<DrawItem>& items, std::vector<DrawItem>& visible) {
+        visible.clear();
+        tested = 0;
+        hidden = 0;
+        for (const DrawItem& item : items) {
+            if (!item.occlusionTest) {
+                visible.push_back(item);
+                continue;
+            }
+
+            tested++;
+            ObjectQuery& object = Get(item.entity);
+            if (object.pending) {
+                GLuint available = 0;
+                glGetQueryObjectuiv(object.query, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available) {
+                    GLuint samples = 0;
+                    glGetQueryObjectuiv(object.query, GL_QUERY_RESULT, &samples);
+                    object.visible = samples != 0;
+                    object.pending = false;
+                }
+            }
+
+            if (object.visible) {
+                visible.push_back(item);
+            }
+            else {
+                hidden++;
+            }
+        }
+    }
+
+    // Call once the depth buffer holds this frame's occluders (after the depth pre-pass, or after drawing
+    // the opaque scene). Draws the bounding box of every occlusion-tested item that has no query in flight,
+    // without touching color or depth, into a new query. boxShader is the position-only depth shader.
+    void IssueQueries(Shader& boxShader, const SceneRenderer& renderer, const std::vector<DrawItem>& items,
+                      const glm::vec3& eye) {
+        GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_CULL_FACE);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        boxShader.use();
+        glBindVertexArray(boxVAO);
+
+        for (const DrawItem& item : items) {
+            if (!item.occlusionTest) continue;
+            ObjectQuery& object = Get(item.entity);
+            if (object.pending) continue;
+
+            Model* model = renderer.GetModel(item.model);
+            if (!model) continue;
+
+            // A little bigger than the model, so it never loses against its own depth
+            glm::vec3 center = (model->boundsMin + model->boundsMax) * 0.5f;
+            glm::vec3 size = (model->boundsMax - model->boundsMin) * 1.05f + glm::vec3(0.001f);
+            glm::mat4 box = glm::scale(glm::translate(item.transform, center), size);
+
+            // The camera inside the box would see only its back faces, could be culled wrongly
+            glm::vec3 worldCenter = glm::vec3(box[3]);
+            float radius = 0.5f * (glm::length(glm::vec3(box[0])) + glm::length(glm::vec3(box[1])) + glm::length(glm::vec3(box[2])));
+            if (glm::length(eye - worldCenter) < radius) {
+                object.visible = true;
+                continue;
+            }
+
+            if (!object.query) {
+                glGenQueries(1, &object.query);
+            }
+            boxShader.setMat4("uM", box);
+            glBeginQuery(GL_ANY_SAMPLES_PASSED, object.query);
+            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+            object.pending = true;
+        }
+
+        glBindVertexArray(0);
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        if (cullFace) {
+            glEnable(GL_CULL_FACE);
+        }
+    }
+
+    int GetTestedCount() const { return tested; } // Occlusion-tested items in the last Filter
+    int GetHiddenCount() const { return hidden; } // Of those, skipped as hidden
+
+private:
+    struct ObjectQuery {
+        GLuint query = 0;
+        uint32_t generation = 0;
+        bool pending = false; // Issued, answer not read yet
+        bool visible = true;
+    };
+
+    GLuint boxVAO = 0, boxVBO = 0, boxEBO = 0;
+    std::vector<ObjectQuery> objects; // By entity index
+    int tested = 0;
+    int hidden = 0;
+
+    // A reused entity index starts over as visible
+    ObjectQuery& Get(Entity entity) {
+        if (entity.index >= objects.size()) {
+            objects.resize(entity.index + 1);
+        }
+        ObjectQuery& object = objects[entity.index];
+        if (object.generation != entity.generation) {
+            object.generation = entity.generation;
+            object.visible = true;
+            object.pending = false;
+        }
+        return object;
+    }
+};
+
+#endif // OCCLUSION_CULLER_HPP
@@ -0,0 +1,20 @@
+#version 330 core
+// Resolves the weighted blended transparency (WeightedOIT) over the frame
+out vec4 FragColor;
+
+in vec2 chUV;
+
+uniform sampler2D uAccumulation; // Weighted premultiplied color sum, revealage in alpha
+uniform sampler2D uWeights;      // Weight sum
+
+void main()
+{
+    vec4 accumulation = texture(uAccumulation, chUV);
+    float revealage = accumulation.a;
+    if (revealage >= 1.0)
+        discard; // Nothing transparent here
+
+    // Average color of the layers, covering 1 - revealage of what's behind
+    vec3 average = accumulation.rgb / max(texture(uWeights, chUV).r, 1e-5);
+    FragColor = vec4(average, 1.0 - revealage);
+}
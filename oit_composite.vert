@@ -0,0 +1,10 @@
+#version 330 core
+// Fullscreen triangle from the vertex id, no vertex buffer
+out vec2 chUV;
+
+void main()
+{
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    chUV = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
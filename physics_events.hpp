@@ -0,0 +1,59 @@
+#ifndef PHYSICS_EVENTS_HPP
+#define PHYSICS_EVENTS_HPP
+
+#include <reactphysics3d/reactphysics3d.h>
+#include "gameobject.hpp"
+
+// Forwards ReactPhysics3D contact and trigger events to the GameObjects involved.
+// The world calls this during PhysicsWorld::update, and only for pairs that actually touch.
+class PhysicsEventListener : public rp3d::EventListener {
+public:
+    void onContact(const rp3d::CollisionCallback::CallbackData& callbackData) override {
+        for (rp3d::uint32 i = 0; i < callbackData.getNbContactPairs(); i++) {
+            rp3d::CollisionCallback::ContactPair pair = callbackData.getContactPair(i);
+
+            PhysicsEvent event = PhysicsEvent::Stay;
+            switch (pair.getEventType()) {
+                case rp3d::CollisionCallback::ContactPair::EventType::ContactStart: event = PhysicsEvent::Enter; break;
+                case rp3d::CollisionCallback::ContactPair::EventType::ContactStay:  event = PhysicsEvent::Stay;  break;
+                case rp3d::CollisionCallback::ContactPair::EventType::ContactExit:  event = PhysicsEvent::Exit;  break;
+            }
+
+            Dispatch(pair.getBody1(), pair.getBody2(), event, false);
+        }
+    }
+
+    void onTrigger(const rp3d::OverlapCallback::CallbackData& callbackData) override {
+        for (rp3d::uint32 i = 0; i < callbackData.getNbOverlappingPairs(); i++) {
+            rp3d::OverlapCallback::OverlapPair pair = callbackData.getOverlappingPair(i);
+
+            PhysicsEvent event = PhysicsEvent::Stay;
+            switch (pair.getEventType()) {
+                case rp3d::OverlapCallback::OverlapPair::EventType::OverlapStart: event = PhysicsEvent::Enter; break;
+                case rp3d::OverlapCallback::OverlapPair::EventType::OverlapStay:  event = PhysicsEvent::Stay;  break;
+                case rp3d::OverlapCallback::OverlapPair::EventType::OverlapExit:  event = PhysicsEvent::Exit;  break;
+            }
+
+            Dispatch(pair.getBody1(), pair.getBody2(), event, true);
+        }
+    }
+
+private:
+    static GameObject* ToGameObject(rp3d::Body* body) {
+        return body ? static_cast<GameObject*>(body->getUserData()) : nullptr;
+    }
+
+    static void Dispatch(rp3d::Body* body1, rp3d::Body* body2, PhysicsEvent event, bool isTrigger) {
+        GameObject* obj1 = ToGameObject(body1);
+        GameObject* obj2 = ToGameObject(body2);
+        if (!obj1 || !obj2) return;
+
+        // Both sides get told, each one sees the other as "other"
+        auto& callback1 = isTrigger ? obj1->onTrigger : obj1->onContact;
+        auto& callback2 = isTrigger ? obj2->onTrigger : obj2->onContact;
+        if (callback1) callback1(obj2, event);
+        if (callback2) callback2(obj1, event);
+    }
+};
+
+#endif // PHYSICS_EVENTS_HPP
@@ -0,0 +1,132 @@
+#ifndef PHYSICS_THREAD_HPP
+#define PHYSICS_THREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <thread>
+
+// Single producer / single consumer ring buffer, no locks.
+// The render thread pushes input commands, the physics thread pops them.
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    // Returns false when full (the command is dropped)
+    bool Push(const T& item) {
+        size_t tail = tailIndex.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) % Capacity;
+        if (next == headIndex.load(std::memory_order_acquire)) return false;
+
+        items[tail] = item;
+        tailIndex.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when empty
+    bool Pop(T& item) {
+        size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire)) return false;
+
+        item = items[head];
+        headIndex.store((head + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[Capacity];
+    std::atomic<size_t> headIndex{ 0 };
+    std::atomic<size_t> tailIndex{ 0 };
+};
+
+
+// Hands whole snapshots from the physics thread to the render thread without locks.
+// Three buffers: one being written, one being read, and the latest finished one in the middle.
+// Publish/Acquire swap indices with a single atomic exchange, so neither side ever waits.
+template <typename T>
+class SnapshotBuffer {
+public:
+    // Physics thread: the buffer to fill for the next Publish
+    T& BeginWrite() {
+        return buffers[writeIndex];
+    }
+
+    // Physics thread: make the written buffer the latest one
+    void Publish() {
+        int previous = middle.exchange(writeIndex | freshFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Render thread: the latest published snapshot (same as last time if nothing new arrived)
+    const T& Acquire() {
+        if (middle.load(std::memory_order_acquire) & freshFlag) {
+            int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & indexMask;
+        }
+        return buffers[readIndex];
+    }
+
+private:
+    static const int indexMask = 0x3;
+    static const int freshFlag = 0x4;
+
+    T buffers[3];
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle{ 2 };
+};
+
+
+// Runs a step function at a fixed rate on its own thread
+class PhysicsThread {
+public:
+    explicit PhysicsThread(double stepRate = 60.0) : stepTime(1.0 / stepRate), running(false) {}
+
+    ~PhysicsThread() {
+        Stop();
+    }
+
+    // step(dt) is called on the physics thread, dt is always the fixed step time
+    void Start(std::function<void(double)> step) {
+        if (running) return;
+
+        stepFunction = step;
+        running = true;
+        thread = std::thread(&PhysicsThread::Run, this);
+    }
+
+    void Stop() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    double GetStepTime() const { return stepTime; }
+
+private:
+    double stepTime;
+    std::atomic<bool> running;
+    std::thread thread;
+    std::function<void(double)> stepFunction;
+
+    void Run() {
+        using clock = std::chrono::steady_clock;
+        const auto stepDuration = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(stepTime));
+        auto nextStep = clock::now();
+
+        while (running) {
+            stepFunction(stepTime);
+
+            nextStep += stepDuration;
+            auto now = clock::now();
+            // Fell way behind (breakpoint, window drag), don't try to catch up all at once
+            if (now > nextStep + stepDuration * 5) {
+                nextStep = now;
+            }
+            std::this_thread::sleep_until(nextStep);
+        }
+    }
+};
+
+#endif // PHYSICS_THREAD_HPP
@@ -0,0 +1,380 @@
+#ifndef PRIZE_SPAWNER_HPP
+#define PRIZE_SPAWNER_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <reactphysics3d/reactphysics3d.h>
+#include "gameobject.hpp"
+#include "log.hpp"
+#include "mesh_data.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// One kind of prize in the pile
+struct PrizeType {
+    std::string modelPath;
+    glm::vec3 scale;
+    glm::vec3 halfExtents; // Box collider
+    float weight;          // Relative share of the mix
+};
+
+struct PrizeSpawnSettings {
+    int count = 20;
+    std::vector<PrizeType> mix;
+
+    // Prize area inside the machine: prizes are stacked upwards from areaMin.y, and the pile starts no higher
+    // than areaMax.y. With a machine mesh the x/z footprint comes from the cabinet instead, see FitArea.
+    glm::vec3 areaMin = glm::vec3(-0.5f, -0.4f, -0.5f);
+    glm::vec3 areaMax = glm::vec3(0.5f, 0.7f, 0.5f);
+
+    // Collision mesh of the cabinet and its world transform. Its walls above the floor give the footprint,
+    // minus wallInset, and the mesh is part of the cache key since the pile settles against it.
+    const MeshData* machine = nullptr;
+    glm::mat4 machineTransform = glm::mat4(1.0f);
+    float wallInset = 0.08f;
+
+    // More prizes than fit under areaMax.y are dropped down to what fits, with a warning. Off for stress
+    // runs (the benchmarks): the extra layers keep stacking above the cabinet and spill out while settling.
+    bool clampToMachine = true;
+
+    unsigned int seed = 1;
+
+    // Pre-settling: step the world until everything sleeps (or we give up)
+    double settleStep = 1.0 / 60.0;
+    int maxSettleSteps = 1200;
+
+    // Settled pile is saved here and restored on later launches with the same settings
+    std::string cachePath = "res/prize_pile.bin";
+};
+
+// Fills the prize area with a pile of prizes, pre-settles it and caches the result.
+// Prizes of the same type share one model id and one collision shape, so spawning and despawning them over
+// and over doesn't pile up shapes in the PhysicsCommon. Destroy the prizes before the spawner, it owns the shapes.
+class PrizeSpawner {
+public:
+    PrizeSpawner(GameObjectManager& objects, rp3d::PhysicsCommon& physicsCommon, rp3d::PhysicsWorld* world)
+        : objects(objects), physicsCommon(physicsCommon), world(world) {}
+
+    ~PrizeSpawner() {
+        for (const SharedShape& shared : shapes) {
+            physicsCommon.destroyBoxShape(shared.shape);
+        }
+    }
+
+    PrizeSpawner(const PrizeSpawner&) = delete;
+    PrizeSpawner& operator=(const PrizeSpawner&) = delete;
+
+    std::vector<GameObject*> Spawn(const PrizeSpawnSettings& requested) {
+        std::vector<GameObject*> prizes;
+        if (requested.mix.empty() || requested.count <= 0) return prizes;
+
+        // A pile taller than the cabinet would spill out of it and never settle
+        PrizeSpawnSettings settings = FitArea(requested);
+        int capacity = Capacity(settings);
+        if (settings.clampToMachine && settings.count > capacity) {
+            Log::Warning("the machine holds ", capacity, " prizes, spawning that many instead of ", settings.count);
+            settings.count = capacity;
+        }
+        pileHash = HashSettings(settings);
+        restored = false;
+
+        // Pick the type of each prize up front so the pile is the same every launch
+        std::mt19937 random(settings.seed);
+        std::vector<float> weights;
+        for (const PrizeType& type : settings.mix) {
+            weights.push_back(type.weight);
+        }
+        std::discrete_distribution<int> pickType(weights.begin(), weights.end());
+
+        std::vector<int> types(settings.count);
+        for (int i = 0; i < settings.count; i++) {
+            types[i] = pickType(random);
+        }
+
+        // Looked up once per type, not per prize
+        std::vector<ModelId> models;
+        std::vector<rp3d::BoxShape*> typeShapes;
+        for (const PrizeType& type : settings.mix) {
+            models.push_back(objects.GetScene().RegisterModel(type.modelPath));
+            typeShapes.push_back(GetBoxShape(type.halfExtents));
+        }
+
+        for (int i = 0; i < settings.count; i++) {
+            GameObject* prize = objects.Create(models[types[i]], world, rp3d::BodyType::DYNAMIC);
+            prize->AddSharedCollision(typeShapes[types[i]]);
+            prize->SetOcclusionTest(true); // Most of a pile is buried at any time
+            objects.GetScene().AddPrize(prize->GetEntity());
+            prizes.push_back(prize);
+        }
+
+        if (LoadSettledPile(settings, types, prizes)) {
+            restored = true;
+            Log::Info("Restored settled pile of ", prizes.size(), " prizes from ", settings.cachePath);
+            return prizes;
+        }
+
+        PlaceInLayers(settings, types, prizes, random);
+        Settle(settings, prizes);
+        SaveSettledPile(settings, types, prizes);
+
+        return prizes;
+    }
+
+    // Takes a prize out of play, its slot is reused by the next Spawn
+    void Despawn(GameObject* prize) {
+        objects.Destroy(prize);
+    }
+
+    size_t GetShapeCount() const { return shapes.size(); } // Box shapes shared by the prizes, one per size
+
+    // Hash of the last Spawn's settings (after fitting them to the machine), the key its pile is cached under
+    uint64_t GetPileHash() const { return pileHash; }
+    // The last Spawn's pile came from the cache instead of being settled just now
+    bool WasRestored() const { return restored; }
+
+private:
+    GameObjectManager& objects;
+    rp3d::PhysicsCommon& physicsCommon;
+    rp3d::PhysicsWorld* world;
+    uint64_t pileHash = 0;
+    bool restored = false;
+
+    struct SharedShape {
+        glm::vec3 halfExtents;
+        rp3d::BoxShape* shape;
+    };
+    std::vector<SharedShape> shapes; // Created on first use, kept for every later Spawn
+
+    rp3d::BoxShape* GetBoxShape(const glm::vec3& halfExtents) {
+        for (const SharedShape& shared : shapes) {
+            if (shared.halfExtents == halfExtents) return shared.shape;
+        }
+        SharedShape shared;
+        shared.halfExtents = halfExtents;
+        shared.shape = physicsCommon.createBoxShape(rp3d::Vector3(halfExtents.x, halfExtents.y, halfExtents.z));
+        shapes.push_back(shared);
+        return shared.shape;
+    }
+
+    // x/z footprint of the cabinet's geometry above the floor (the base and control panel below it stick
+    // out further), minus the walls. Without a machine the configured area is used as is.
+    static PrizeSpawnSettings FitArea(const PrizeSpawnSettings& settings) {
+        PrizeSpawnSettings fitted = settings;
+        if (!settings.machine) return fitted;
+
+        bool found = false;
+        glm::vec3 footprintMin(0.0f), footprintMax(0.0f); // y unused
+        for (const glm::vec3& local : settings.machine->positions) {
+            glm::vec3 position = glm::vec3(settings.machineTransform * glm::vec4(local, 1.0f));
+            if (position.y <= settings.areaMin.y) continue;
+            footprintMin = found ? glm::min(footprintMin, position) : position;
+            footprintMax = found ? glm::max(footprintMax, position) : position;
+            found = true;
+        }
+        if (!found) return fitted;
+
+        fitted.areaMin.x = footprintMin.x + settings.wallInset;
+        fitted.areaMin.z = footprintMin.z + settings.wallInset;
+        fitted.areaMax.x = glm::max(fitted.areaMin.x, footprintMax.x - settings.wallInset);
+        fitted.areaMax.z = glm::max(fitted.areaMin.z, footprintMax.z - settings.wallInset);
+        return fitted;
+    }
+
+    // Grid cell big enough for the largest prize in any orientation, plus some room
+    static float CellSize(const PrizeSpawnSettings& settings) {
+        float cellSize = 0.0f;
+        for (const PrizeType& type : settings.mix) {
+            cellSize = glm::max(cellSize, 2.2f * glm::max(type.halfExtents.x, glm::max(type.halfExtents.y, type.halfExtents.z)));
+        }
+        return cellSize;
+    }
+
+    static void GridSize(const PrizeSpawnSettings& settings, int& columns, int& rows, int& layers) {
+        float cellSize = CellSize(settings);
+        glm::vec3 areaSize = settings.areaMax - settings.areaMin;
+        columns = glm::max(1, static_cast<int>(areaSize.x / cellSize));
+        rows = glm::max(1, static_cast<int>(areaSize.z / cellSize));
+        layers = glm::max(1, static_cast<int>(areaSize.y / cellSize));
+    }
+
+    static int Capacity(const PrizeSpawnSettings& settings) {
+        int columns, rows, layers;
+        GridSize(settings, columns, rows, layers);
+        return columns * rows * layers;
+    }
+
+    // Jittered grid over the whole footprint, one layer on top of the other
+    void PlaceInLayers(const PrizeSpawnSettings& settings, const std::vector<int>& types,
+                       std::vector<GameObject*>& prizes, std::mt19937& random) {
+        float cellSize = CellSize(settings);
+        int columns, rows, layers;
+        GridSize(settings, columns, rows, layers);
+        int perLayer = columns * rows;
+
+        // Centered, the leftover of the footprint split between the sides
+        glm::vec3 areaSize = settings.areaMax - settings.areaMin;
+        float startX = settings.areaMin.x + 0.5f * (areaSize.x - columns * cellSize);
+        float startZ = settings.areaMin.z + 0.5f * (areaSize.z - rows * cellSize);
+
+        std::uniform_real_distribution<float> jitter(-0.1f * cellSize, 0.1f * cellSize);
+        std::uniform_real_distribution<float> yaw(0.0f, 360.0f);
+
+        for (size_t i = 0; i < prizes.size(); i++) {
+            int layer = static_cast<int>(i) / perLayer;
+            int cell = static_cast<int>(i) % perLayer;
+
+            glm::vec3 position;
+            position.x = startX + (cell % columns + 0.5f) * cellSize + jitter(random);
+            position.z = startZ + (cell / columns + 0.5f) * cellSize + jitter(random);
+            position.y = settings.areaMin.y + (layer + 0.5f) * cellSize;
+
+            glm::quat rotation = glm::angleAxis(glm::radians(yaw(random)), glm::vec3(0.0f, 1.0f, 0.0f));
+            prizes[i]->SetTRS(position, rotation, settings.mix[types[i]].scale);
+        }
+    }
+
+    void Settle(const PrizeSpawnSettings& settings, std::vector<GameObject*>& prizes) {
+        int steps = 0; // World updates actually run
+        while (steps < settings.maxSettleSteps) {
+            world->update(static_cast<rp3d::decimal>(settings.settleStep));
+            steps++;
+
+            // Checking every step is a waste with thousands of prizes
+            if (steps % 30 == 0 && AllAsleep(prizes)) {
+                break;
+            }
+        }
+
+        for (GameObject* prize : prizes) {
+            prize->SyncTransformFromPhysics(true);
+        }
+
+        Log::Info("Settled ", prizes.size(), " prizes in ", steps, " steps");
+    }
+
+    static bool AllAsleep(const std::vector<GameObject*>& prizes) {
+        for (GameObject* prize : prizes) {
+            if (!prize->GetRigidBody()->isSleeping()) return false;
+        }
+        return true;
+    }
+
+    // ---------------- Settled pile cache ----------------
+    // Layout: magic, version, settings hash, count, then per prize: type, position, rotation (xyzw)
+
+    enum : uint32_t {
+        cacheMagic = 0x50525A31, // "PRZ1"
+        cacheVersion = 2
+    };
+
+    // FNV-1a over everything that changes how the pile ends up
+    static uint64_t HashSettings(const PrizeSpawnSettings& settings) {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        };
+
+        mix(&settings.count, sizeof(settings.count));
+        mix(&settings.seed, sizeof(settings.seed));
+        mix(&settings.areaMin, sizeof(settings.areaMin));
+        mix(&settings.areaMax, sizeof(settings.areaMax));
+        mix(&settings.settleStep, sizeof(settings.settleStep));
+        mix(&settings.maxSettleSteps, sizeof(settings.maxSettleSteps));
+        mix(&settings.clampToMachine, sizeof(settings.clampToMachine));
+        if (settings.machine) {
+            mix(settings.machine->positions.data(), settings.machine->positions.size() * sizeof(glm::vec3));
+            mix(settings.machine->indices.data(), settings.machine->indices.size() * sizeof(unsigned int));
+            mix(&settings.machineTransform, sizeof(settings.machineTransform));
+        }
+        for (const PrizeType& type : settings.mix) {
+            mix(type.modelPath.data(), type.modelPath.size());
+            mix(&type.scale, sizeof(type.scale));
+            mix(&type.halfExtents, sizeof(type.halfExtents));
+            mix(&type.weight, sizeof(type.weight));
+        }
+        return hash;
+    }
+
+    struct CachedPrize {
+        uint32_t type;
+        float position[3];
+        float rotation[4];
+    };
+
+    void SaveSettledPile(const PrizeSpawnSettings& settings, const std::vector<int>& types,
+                         const std::vector<GameObject*>& prizes) {
+        std::ofstream file(settings.cachePath, std::ios::binary);
+        if (!file) {
+            Log::Warning("could not write prize pile cache ", settings.cachePath);
+            return;
+        }
+
+        uint32_t magic = cacheMagic;
+        uint32_t version = cacheVersion;
+        uint64_t hash = HashSettings(settings);
+        uint32_t count = static_cast<uint32_t>(prizes.size());
+        file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+        for (size_t i = 0; i < prizes.size(); i++) {
+            glm::vec3 position = prizes[i]->GetPosition();
+            glm::quat rotation = prizes[i]->GetRotation();
+            CachedPrize cached = {
+                static_cast<uint32_t>(types[i]),
+                { position.x, position.y, position.z },
+                { rotation.x, rotation.y, rotation.z, rotation.w }
+            };
+            file.write(reinterpret_cast<const char*>(&cached), sizeof(cached));
+        }
+    }
+
+    bool LoadSettledPile(const PrizeSpawnSettings& settings, const std::vector<int>& types,
+                         std::vector<GameObject*>& prizes) {
+        std::ifstream file(settings.cachePath, std::ios::binary);
+        if (!file) return false;
+
+        uint32_t magic = 0, version = 0, count = 0;
+        uint64_t hash = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        file.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+        file.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+        // Stale cache (different settings or format), resimulate
+        if (!file || magic != cacheMagic || version != cacheVersion ||
+            hash != HashSettings(settings) || count != prizes.size()) {
+            return false;
+        }
+
+        std::vector<CachedPrize> cached(count);
+        file.read(reinterpret_cast<char*>(cached.data()), count * sizeof(CachedPrize));
+        if (!file) return false;
+
+        for (size_t i = 0; i < prizes.size(); i++) {
+            if (cached[i].type != static_cast<uint32_t>(types[i])) return false;
+        }
+
+        for (size_t i = 0; i < prizes.size(); i++) {
+            GameObject* prize = prizes[i];
+            glm::vec3 position(cached[i].position[0], cached[i].position[1], cached[i].position[2]);
+            glm::quat rotation(cached[i].rotation[3], cached[i].rotation[0], cached[i].rotation[1], cached[i].rotation[2]);
+            prize->SetTRS(position, rotation, settings.mix[types[i]].scale);
+
+            // It was at rest when saved, no need to wake the whole pile up
+            prize->GetRigidBody()->setIsSleeping(true);
+        }
+        return true;
+    }
+};
+
+#endif // PRIZE_SPAWNER_HPP
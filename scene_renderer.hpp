@@ -0,0 +1,228 @@
+#ifndef SCENE_RENDERER_HPP
+#define SCENE_RENDERER_HPP
+
+#include <GL/glew.h>
+#include "ecs.hpp"
+#include "model.hpp"
+#include "shader.hpp"
+#include "shader_variants.hpp"
+#include "weighted_oit.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// GL side of the scene. The simulation only hands out model ids and DrawItems, this loads the Model behind
+// each id and draws the items, every mesh with the shader variant its material needs. Never writes to the scene.
+class SceneRenderer {
+public:
+    // Set before LoadModels, variants are compiled there
+    LightType lightType = LightType::Point;
+    bool clusteredLights = false; // Bind a LightClusters before drawing
+    bool shadows = false;         // Bind a ShadowMap before drawing
+    ~SceneRenderer() {
+        for (Model* model : models) {
+            delete model;
+        }
+    }
+
+    // Loads every model the scene registered since the last call, and compiles the shader variants their
+    // meshes need so nothing compiles mid-frame. Needs the GL context, and the scene must not be registering
+    // models at the same time (they're all registered while the game is set up).
+    void LoadModels(const Scene& scene, ShaderVariants& shaders) {
+        for (size_t i = models.size(); i < scene.ModelCount(); i++) {
+            Model* model = new Model(scene.GetModelPath(static_cast<ModelId>(i)));
+            for (const Mesh& mesh : model->meshes) {
+                shaders.Get(GetPermutation(mesh));
+                // Transparency can be switched between sorted and weighted blended at runtime
+                if (mesh.permutation.alpha == AlphaMode::Blended) {
+                    shaders.Get(GetPermutation(mesh, true));
+                }
+            }
+            models.push_back(model);
+        }
+    }
+
+    // nullptr for ids that haven't been loaded
+    Model* GetModel(ModelId id) const {
+        return id < models.size() ? models[id] : nullptr;
+    }
+
+    // Depth pre-pass: fills the depth buffer from the opaque meshes with a position-only shader and no color
+    // writes, so the lit pass after it runs once per visible pixel. Alpha-tested meshes need their texture to
+    // know their depth and blended ones don't write any, both are left to Draw. Returns the draw calls.
+    int DrawDepth(Shader& depthShader, const std::vector<DrawItem>& items, bool backfaceCulling) {
+        int drawCalls = 0;
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        depthShader.use();
+        for (const DrawItem& item : items) {
+            Model* model = GetModel(item.model);
+            if (!model) continue;
+
+            if (item.twoSided && backfaceCulling) {
+                glDisable(GL_CULL_FACE);
+            }
+
+            bool transformSet = false;
+            for (Mesh& mesh : model->meshes) {
+                if (mesh.permutation.alpha != AlphaMode::Opaque) continue;
+                if (!transformSet) {
+                    depthShader.setMat4("uM", item.transform);
+                    transformSet = true;
+                }
+                mesh.DrawGeometry();
+                drawCalls++;
+            }
+
+            if (item.twoSided && backfaceCulling) {
+                glEnable(GL_CULL_FACE);
+            }
+        }
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        return drawCalls;
+    }
+
+    // Opaque and alpha-tested meshes. Returns the number of meshes drawn (one draw call each).
+    // depthPrepassed = DrawDepth ran first this frame: opaque meshes then test GL_EQUAL against it and don't
+    // write depth again. Blended meshes are left to DrawTransparent.
+    int Draw(ShaderVariants& shaders, const std::vector<DrawItem>& items, bool backfaceCulling, bool depthPrepassed = false) {
+        int drawCalls = 0;
+        const Shader* bound = nullptr;
+        DepthState depthState = DepthState::Write;
+        for (const DrawItem& item : items) {
+            Model* model = GetModel(item.model);
+            if (!model) continue;
+
+            // Two-sided models (the claw machine) would lose their inside walls to culling
+            if (item.twoSided && backfaceCulling) {
+                glDisable(GL_CULL_FACE);
+            }
+
+            const Shader* transformSet = nullptr;
+            for (Mesh& mesh : model->meshes) {
+                if (mesh.permutation.alpha == AlphaMode::Blended) continue;
+
+                if (depthPrepassed && mesh.permutation.alpha == AlphaMode::Opaque) {
+                    SetDepthState(depthState, DepthState::Equal);
+                }
+                else {
+                    SetDepthState(depthState, DepthState::Write);
+                }
+
+                ShaderPermutation permutation = GetPermutation(mesh);
+                Shader& shader = shaders.Get(permutation);
+                if (&shader != bound) {
+                    shaders.Use(permutation);
+                    bound = &shader;
+                }
+                if (&shader != transformSet) {
+                    shader.setMat4("uM", item.transform);
+                    transformSet = &shader;
+                }
+                mesh.Draw(shader);
+                drawCalls++;
+            }
+
+            if (item.twoSided && backfaceCulling) {
+                glEnable(GL_CULL_FACE);
+            }
+        }
+        SetDepthState(depthState, DepthState::Write);
+        return drawCalls;
+    }
+
+    // Blended meshes of every item, after Draw, without writing depth. Without a WeightedOIT they're sorted
+    // back to front by their centers across the whole scene, so the cabinet glass blends over the prizes and
+    // claw behind it whatever order the items come in. With one they're drawn unsorted into its targets and
+    // composited, which doesn't depend on order at all. Returns the draw calls.
+    int DrawTransparent(ShaderVariants& shaders, const std::vector<DrawItem>& items, const glm::vec3& eye,
+                        bool backfaceCulling, WeightedOIT* weightedOIT = nullptr, int framebufferWidth = 0,
+                        int framebufferHeight = 0) {
+        transparent.clear();
+        for (size_t i = 0; i < items.size(); i++) {
+            Model* model = GetModel(items[i].model);
+            if (!model) continue;
+            for (Mesh& mesh : model->meshes) {
+                if (mesh.permutation.alpha != AlphaMode::Blended) continue;
+                glm::vec3 toEye = glm::vec3(items[i].transform * glm::vec4(mesh.center, 1.0f)) - eye;
+                transparent.push_back({ &mesh, i, glm::dot(toEye, toEye) });
+            }
+        }
+        if (transparent.empty()) return 0;
+
+        if (weightedOIT) {
+            weightedOIT->Begin(framebufferWidth, framebufferHeight);
+        }
+        else {
+            std::sort(transparent.begin(), transparent.end(),
+                [](const TransparentMesh& a, const TransparentMesh& b) { return a.distance > b.distance; });
+            glDepthMask(GL_FALSE);
+        }
+
+        const Shader* bound = nullptr;
+        const Shader* transformSet = nullptr;
+        size_t transformItem = items.size();
+        for (const TransparentMesh& entry : transparent) {
+            const DrawItem& item = items[entry.item];
+            ShaderPermutation permutation = GetPermutation(*entry.mesh, weightedOIT != nullptr);
+            Shader& shader = shaders.Get(permutation);
+            if (&shader != bound) {
+                shaders.Use(permutation);
+                bound = &shader;
+            }
+            if (&shader != transformSet || entry.item != transformItem) {
+                shader.setMat4("uM", item.transform);
+                transformSet = &shader;
+                transformItem = entry.item;
+            }
+
+            if (item.twoSided && backfaceCulling) {
+                glDisable(GL_CULL_FACE);
+            }
+            entry.mesh->Draw(shader);
+            if (item.twoSided && backfaceCulling) {
+                glEnable(GL_CULL_FACE);
+            }
+        }
+
+        if (weightedOIT) {
+            weightedOIT->Composite();
+        }
+        else {
+            glDepthMask(GL_TRUE);
+        }
+        return static_cast<int>(transparent.size());
+    }
+
+private:
+    enum class DepthState {
+        Write, // GL_LESS, writes depth (the default)
+        Equal  // GL_EQUAL, no writes: opaque meshes after the pre-pass
+    };
+
+    struct TransparentMesh {
+        Mesh* mesh;
+        size_t item;    // Index into the items
+        float distance; // Squared, from the eye to the mesh's center
+    };
+
+    std::vector<Model*> models; // Indexed by ModelId
+    std::vector<TransparentMesh> transparent; // Reused every frame
+
+    static void SetDepthState(DepthState& current, DepthState state) {
+        if (current == state) return;
+        glDepthFunc(state == DepthState::Equal ? GL_EQUAL : GL_LESS);
+        glDepthMask(state == DepthState::Write ? GL_TRUE : GL_FALSE);
+        current = state;
+    }
+
+    ShaderPermutation GetPermutation(const Mesh& mesh, bool weightedBlended = false) const {
+        ShaderPermutation permutation = mesh.permutation;
+        permutation.weightedBlended = weightedBlended;
+        permutation.light = lightType;
+        permutation.clusteredLights = clusteredLights;
+        permutation.shadows = shadows;
+        return permutation;
+    }
+};
+
+#endif // SCENE_RENDERER_HPP
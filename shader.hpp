@@ -4,72 +4,161 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
+    // constructor generates the shader on the fly. The linked program is cached in res/ (see
+    // LoadProgramBinary), later launches with the same sources and driver skip compiling.
+    // defines ("#define TEXTURED\n...") go right after the #version line of both stages, for variants
+    // of the same files (see ShaderVariants).
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines = std::string())
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(defines)
     {
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
+        if (!ReadSources(this->vertexPath, this->fragmentPath, vertexCode, fragmentCode, defines))
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << vertexPath << ", " << fragmentPath << std::endl;
         }
-        catch (std::ifstream::failure& e)
+        // 2. try the program binary cached by an earlier launch, 3. compile if there's none
+        std::string cachePath = ProgramCachePath(vertexPath, fragmentPath, defines);
+        uint64_t cacheKey = ProgramCacheKey(vertexCode, fragmentCode);
+        ID = glCreateProgram();
+        if (!LoadProgramBinary(ID, cachePath, cacheKey))
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+            // A failed glProgramBinary can leave the program in a bad state, start over with a fresh one
+            glDeleteProgram(ID);
+            ID = CompileProgram(vertexCode, fragmentCode);
+            SaveProgramBinary(ID, cachePath, cacheKey);
         }
+
+        // Visible to ShaderReloader from here on
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        serial = NextSerial()++;
+        Registry().push_back(this);
+    }
+
+    ~Shader()
+    {
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        std::vector<Shader*>& registry = Registry();
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+    }
+
+    // Registered by address, copies would go stale
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    const std::string& GetVertexPath() const { return vertexPath; }
+    const std::string& GetFragmentPath() const { return fragmentPath; }
+    const std::string& GetDefines() const { return defines; }
+
+    // ---------------- Hot reload (used by ShaderReloader) ----------------
+
+    // Reads both files and inserts the defines, false if either can't be read
+    static bool ReadSources(const std::string& vertexPath, const std::string& fragmentPath,
+                            std::string& vertexCode, std::string& fragmentCode,
+                            const std::string& defines = std::string())
+    {
+        std::ifstream vShaderFile(vertexPath);
+        std::ifstream fShaderFile(fragmentPath);
+        if (!vShaderFile || !fShaderFile)
+            return false;
+        std::stringstream vShaderStream, fShaderStream;
+        vShaderStream << vShaderFile.rdbuf();
+        fShaderStream << fShaderFile.rdbuf();
+        vertexCode = InsertDefines(vShaderStream.str(), defines);
+        fragmentCode = InsertDefines(fShaderStream.str(), defines);
+        return true;
+    }
+
+    // GLSL wants #version first, so the defines go on the line after it
+    static std::string InsertDefines(const std::string& code, const std::string& defines)
+    {
+        if (defines.empty())
+            return code;
+        size_t version = code.find("#version");
+        if (version == std::string::npos)
+            return defines + code;
+        size_t lineEnd = code.find('\n', version);
+        if (lineEnd == std::string::npos)
+            return code + "\n" + defines;
+        return code.substr(0, lineEnd + 1) + defines + code.substr(lineEnd + 1);
+    }
+
+    // Compiles and links a new program on the current context. Errors are printed and ok is set to false,
+    // the (broken) program is still returned.
+    static unsigned int CompileProgram(const std::string& vertexCode, const std::string& fragmentCode, bool* ok = nullptr)
+    {
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
         glShaderSource(vertex, 1, &vShaderCode, NULL);
         glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+        bool success = checkCompileErrors(vertex, "VERTEX");
         // fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragment, 1, &fShaderCode, NULL);
         glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        success = checkCompileErrors(fragment, "FRAGMENT") && success;
         // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        if (ProgramBinarySupported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program);
+        success = checkCompileErrors(program, "PROGRAM") && success;
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+        if (ok)
+            *ok = success;
+        return program;
+    }
+
+    // Switches to a program compiled from newer sources (call on the render thread, between frames).
+    // Uniform values and block bindings carry over, so whatever was set once at startup stays set.
+    void ReplaceProgram(unsigned int newProgram)
+    {
+        GLint current = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+
+        glUseProgram(newProgram);
+        CopyUniforms(ID, newProgram);
+        glUseProgram(current == static_cast<GLint>(ID) ? newProgram : static_cast<unsigned int>(current));
+
+        glDeleteProgram(ID);
+        ID = newProgram;
+    }
 
+    // Calls f(shader) for every live Shader while holding the registry lock
+    template <typename Function>
+    static void ForEachShader(Function f)
+    {
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        for (Shader* shader : Registry())
+            f(*shader);
     }
+
+    // Unique per Shader, unlike its address
+    uint64_t GetSerial() const { return serial; }
+
     // activate the shader
     // ------------------------------------------------------------------------
     void use() const
@@ -135,10 +224,246 @@ public:
         glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
     }
 
+    // ---------------- Program binary cache ----------------
+    // One file per vertex/fragment pair: magic, version, key, binary format, length, binary.
+    // The key covers both sources and the driver (vendor, renderer, version), since binaries are only
+    // valid for the driver that produced them. Anything that doesn't match is recompiled and overwritten.
+
+    // GL 4.1 or ARB_get_program_binary, and a driver that actually offers a binary format
+    static bool ProgramBinarySupported()
+    {
+        if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    // Variants of the same files get their own file, named by a hash of the defines
+    static std::string ProgramCachePath(const char* vertexPath, const char* fragmentPath,
+                                        const std::string& defines = std::string())
+    {
+        std::string name = std::string(vertexPath) + "_" + fragmentPath;
+        for (char& c : name)
+        {
+            if (c == '/' || c == '\\' || c == ':')
+                c = '_';
+        }
+        if (!defines.empty())
+        {
+            uint32_t hash = 2166136261u;
+            for (unsigned char c : defines)
+            {
+                hash ^= c;
+                hash *= 16777619u;
+            }
+            char suffix[16];
+            snprintf(suffix, sizeof(suffix), "_%08x", hash);
+            name += suffix;
+        }
+        return "res/shader_" + name + ".bin";
+    }
+
+    // FNV-1a over the sources and the driver strings
+    static uint64_t ProgramCacheKey(const std::string& vertexCode, const std::string& fragmentCode)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const std::string& text)
+        {
+            for (unsigned char c : text)
+            {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+            // Separator, so "ab" + "c" and "a" + "bc" don't collide
+            hash ^= 0xFF;
+            hash *= 1099511628211ull;
+        };
+
+        mix(vertexCode);
+        mix(fragmentCode);
+        const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (GLenum name : driverStrings)
+        {
+            const GLubyte* value = glGetString(name);
+            mix(value ? reinterpret_cast<const char*>(value) : "");
+        }
+        return hash;
+    }
+
+    // Links program from the cached binary, false if there's none or the driver rejects it
+    static bool LoadProgramBinary(unsigned int program, const std::string& path, uint64_t key)
+    {
+        if (!ProgramBinarySupported())
+            return false;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        uint32_t magic = 0, version = 0, format = 0, length = 0;
+        uint64_t fileKey = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        file.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey));
+        file.read(reinterpret_cast<char*>(&format), sizeof(format));
+        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        if (!file || magic != cacheMagic || version != cacheVersion || fileKey != key || length == 0)
+            return false;
+
+        std::vector<char> binary(length);
+        file.read(binary.data(), length);
+        if (!file)
+            return false;
+
+        glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(length));
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success != 0;
+    }
+
+    // Only programs that linked
+    static void SaveProgramBinary(unsigned int program, const std::string& path, uint64_t key)
+    {
+        if (!ProgramBinarySupported())
+            return;
+
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+            return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "Warning: could not write shader cache " << path << std::endl;
+            return;
+        }
+
+        uint32_t magic = cacheMagic;
+        uint32_t version = cacheVersion;
+        uint32_t binaryFormat = format;
+        uint32_t binaryLength = static_cast<uint32_t>(length);
+        file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        file.write(reinterpret_cast<const char*>(&binaryFormat), sizeof(binaryFormat));
+        file.write(reinterpret_cast<const char*>(&binaryLength), sizeof(binaryLength));
+        file.write(binary.data(), length);
+    }
+
 private:
-    // utility function for checking shader compilation/linking errors.
+    enum : uint32_t
+    {
+        cacheMagic = 0x50524731, // "PRG1"
+        cacheVersion = 1
+    };
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string defines;
+    uint64_t serial = 0;
+
+    static std::mutex& RegistryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    // Every live Shader
+    static std::vector<Shader*>& Registry()
+    {
+        static std::vector<Shader*> shaders;
+        return shaders;
+    }
+
+    static uint64_t& NextSerial()
+    {
+        static uint64_t next = 1;
+        return next;
+    }
+
+    // Uniforms inside blocks have no location and are skipped, the block bindings are copied instead
+    static void CopyUniforms(unsigned int from, unsigned int to)
+    {
+        GLint count = 0;
+        glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLchar name[256];
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(from, static_cast<GLuint>(i), sizeof(name), NULL, &size, &type, name);
+
+            // Arrays are reported as "name[0]", copy every element
+            std::string base = name;
+            if (size > 1 && base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0)
+                base.erase(base.size() - 3);
+
+            for (GLint element = 0; element < size; element++)
+            {
+                std::string elementName = size > 1 ? base + "[" + std::to_string(element) + "]" : std::string(name);
+                GLint source = glGetUniformLocation(from, elementName.c_str());
+                GLint target = glGetUniformLocation(to, elementName.c_str());
+                if (source < 0 || target < 0)
+                    continue;
+                CopyUniform(from, source, target, type);
+            }
+        }
+
+        GLint blocks = 0;
+        glGetProgramiv(from, GL_ACTIVE_UNIFORM_BLOCKS, &blocks);
+        for (GLint i = 0; i < blocks; i++)
+        {
+            GLchar name[256];
+            glGetActiveUniformBlockName(from, static_cast<GLuint>(i), sizeof(name), NULL, name);
+            GLuint target = glGetUniformBlockIndex(to, name);
+            if (target == GL_INVALID_INDEX)
+                continue;
+            GLint binding = 0;
+            glGetActiveUniformBlockiv(from, static_cast<GLuint>(i), GL_UNIFORM_BLOCK_BINDING, &binding);
+            glUniformBlockBinding(to, target, static_cast<GLuint>(binding));
+        }
+    }
+
+    // Into the currently bound program
+    static void CopyUniform(unsigned int from, GLint source, GLint target, GLenum type)
+    {
+        GLfloat f[16];
+        GLint n[4];
+        switch (type)
+        {
+        case GL_FLOAT:      glGetUniformfv(from, source, f); glUniform1fv(target, 1, f); break;
+        case GL_FLOAT_VEC2: glGetUniformfv(from, source, f); glUniform2fv(target, 1, f); break;
+        case GL_FLOAT_VEC3: glGetUniformfv(from, source, f); glUniform3fv(target, 1, f); break;
+        case GL_FLOAT_VEC4: glGetUniformfv(from, source, f); glUniform4fv(target, 1, f); break;
+        case GL_FLOAT_MAT2: glGetUniformfv(from, source, f); glUniformMatrix2fv(target, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3: glGetUniformfv(from, source, f); glUniformMatrix3fv(target, 1, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4: glGetUniformfv(from, source, f); glUniformMatrix4fv(target, 1, GL_FALSE, f); break;
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:  glGetUniformiv(from, source, n); glUniform2iv(target, 1, n); break;
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:  glGetUniformiv(from, source, n); glUniform3iv(target, 1, n); break;
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:  glGetUniformiv(from, source, n); glUniform4iv(target, 1, n); break;
+        default:
+            // int, bool and samplers (texture unit)
+            glGetUniformiv(from, source, n); glUniform1iv(target, 1, n); break;
+        }
+    }
+
+    // utility function for checking shader compilation/linking errors. Returns true on success.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(GLuint shader, std::string type)
+    static bool checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
         GLchar infoLog[1024];
@@ -160,6 +485,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
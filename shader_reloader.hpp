@@ -0,0 +1,175 @@
+#ifndef SHADER_RELOADER_HPP
+#define SHADER_RELOADER_HPP
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "shader.hpp"
+
+#include <sys/stat.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches the source files of every Shader and recompiles the ones that changed on a background thread,
+// using a hidden window whose context shares objects with the game's. Finished programs wait until Apply
+// swaps them in between frames; a program that doesn't compile is thrown away and the old one stays.
+class ShaderReloader {
+public:
+    // Call on the main thread after GLEW is initialized, with the game window's context current
+    explicit ShaderReloader(GLFWwindow* mainWindow, double pollInterval = 0.5)
+        : pollInterval(pollInterval) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        context = glfwCreateWindow(1, 1, "Shader reload", NULL, mainWindow);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+        if (!context) {
+            std::cout << "Warning: no shared context, shader hot reload is off" << std::endl;
+            return;
+        }
+
+        running = true;
+        thread = std::thread(&ShaderReloader::Run, this);
+    }
+
+    // Main thread, before glfwTerminate
+    ~ShaderReloader() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+        for (const Compiled& compiled : finished) {
+            glDeleteProgram(compiled.program);
+        }
+        if (context) {
+            glfwDestroyWindow(context);
+        }
+    }
+
+    ShaderReloader(const ShaderReloader&) = delete;
+    ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+    bool IsRunning() const { return running; }
+
+    // Render thread, once per frame before drawing. Returns how many shaders were swapped.
+    int Apply() {
+        std::vector<Compiled> ready;
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            ready.swap(finished);
+        }
+
+        int swapped = 0;
+        for (const Compiled& compiled : ready) {
+            bool used = false;
+            Shader::ForEachShader([&](Shader& shader) {
+                if (!used && shader.GetSerial() == compiled.serial) {
+                    shader.ReplaceProgram(compiled.program);
+                    std::cout << "Reloaded " << shader.GetVertexPath() << " + " << shader.GetFragmentPath() << std::endl;
+                    used = true;
+                }
+            });
+
+            // The shader went away while its new program was compiling
+            if (!used) {
+                glDeleteProgram(compiled.program);
+            }
+            else {
+                swapped++;
+            }
+        }
+        return swapped;
+    }
+
+private:
+    struct Watched {
+        uint64_t serial;
+        std::string vertexPath;
+        std::string fragmentPath;
+        std::string defines;
+    };
+
+    struct Compiled {
+        uint64_t serial;
+        unsigned int program;
+    };
+
+    double pollInterval;
+    GLFWwindow* context = nullptr;
+    std::atomic<bool> running{ false };
+    std::thread thread;
+
+    std::mutex finishedMutex;
+    std::vector<Compiled> finished;
+
+    // Background thread only: file stamps as of the last compile, per shader
+    std::map<uint64_t, std::string> stamps;
+
+    // Modification time and size, so a save within the same second still counts as a change
+    static std::string FileStamp(const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) return std::string();
+        return std::to_string(static_cast<long long>(info.st_mtime)) + ":" + std::to_string(static_cast<long long>(info.st_size));
+    }
+
+    void Run() {
+        glfwMakeContextCurrent(context);
+
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(pollInterval));
+
+            // Copy out what to watch, the shaders themselves belong to the render thread
+            std::vector<Watched> watched;
+            Shader::ForEachShader([&watched](Shader& shader) {
+                Watched entry = { shader.GetSerial(), shader.GetVertexPath(), shader.GetFragmentPath(), shader.GetDefines() };
+                watched.push_back(entry);
+            });
+
+            for (const Watched& entry : watched) {
+                std::string stamp = FileStamp(entry.vertexPath) + "|" + FileStamp(entry.fragmentPath);
+                auto it = stamps.find(entry.serial);
+                if (it == stamps.end()) {
+                    stamps[entry.serial] = stamp; // First look, that's what it was compiled from
+                    continue;
+                }
+                if (it->second == stamp) continue;
+                it->second = stamp;
+
+                Compile(entry);
+            }
+        }
+
+        glfwMakeContextCurrent(NULL);
+    }
+
+    void Compile(const Watched& entry) {
+        std::string vertexCode, fragmentCode;
+        if (!Shader::ReadSources(entry.vertexPath, entry.fragmentPath, vertexCode, fragmentCode, entry.defines)) return;
+
+        bool ok = false;
+        unsigned int program = Shader::CompileProgram(vertexCode, fragmentCode, &ok);
+        if (!ok) {
+            std::cout << "Keeping the old " << entry.vertexPath << " + " << entry.fragmentPath << " (compile failed)" << std::endl;
+            glDeleteProgram(program);
+            return;
+        }
+
+        // Same cache the next launch reads
+        Shader::SaveProgramBinary(program, Shader::ProgramCachePath(entry.vertexPath.c_str(), entry.fragmentPath.c_str(), entry.defines),
+                                  Shader::ProgramCacheKey(vertexCode, fragmentCode));
+
+        // Done on this context before the render thread uses it
+        glFinish();
+
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        Compiled compiled = { entry.serial, program };
+        finished.push_back(compiled);
+    }
+};
+
+#endif // SHADER_RELOADER_HPP
@@ -0,0 +1,207 @@
+#ifndef SHADER_VARIANTS_HPP
+#define SHADER_VARIANTS_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "shader.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class AlphaMode : uint8_t {
+    Opaque,      // Alpha ignored
+    AlphaTested, // Texture alpha, cut out below 0.1
+    Blended      // Texture alpha times the material's opacity, drawn after the rest without depth writes
+};
+
+enum class LightType : uint8_t {
+    Point,      // uLightPos
+    Directional // uLightDir
+};
+
+// Which variant of a shader a material needs. Every field turns into a #define, so the fragment shader
+// only contains the work that material actually does instead of branching on uniforms.
+struct ShaderPermutation {
+    bool textured = false;
+    AlphaMode alpha = AlphaMode::Opaque;
+    LightType light = LightType::Point;
+    bool clusteredLights = false; // Also the scene's many small lights (LightClusters)
+    bool shadows = false;         // Main light shadowed through a ShadowMap
+    bool weightedBlended = false; // Blended meshes write into a WeightedOIT target instead of blending in order
+
+    static const uint32_t keyCount = 2 * 3 * 2 * 2 * 2 * 2;
+
+    uint32_t Key() const {
+        return (textured ? 1u : 0u) + 2u * static_cast<uint32_t>(alpha) + 6u * static_cast<uint32_t>(light) +
+               12u * (clusteredLights ? 1u : 0u) + 24u * (shadows ? 1u : 0u) + 48u * (weightedBlended ? 1u : 0u);
+    }
+
+    std::string Defines() const {
+        std::string defines;
+        if (textured) defines += "#define TEXTURED\n";
+        switch (alpha) {
+        case AlphaMode::Opaque:      defines += "#define ALPHA_OPAQUE\n"; break;
+        case AlphaMode::AlphaTested: defines += "#define ALPHA_TEST\n"; break;
+        case AlphaMode::Blended:     defines += "#define ALPHA_BLEND\n"; break;
+        }
+        defines += light == LightType::Directional ? "#define LIGHT_DIRECTIONAL\n" : "#define LIGHT_POINT\n";
+        if (clusteredLights) defines += "#define CLUSTERED_LIGHTS\n";
+        if (shadows) defines += "#define SHADOWS\n";
+        if (weightedBlended) defines += "#define WEIGHTED_OIT\n";
+        return defines;
+    }
+};
+
+// All variants of one vertex/fragment pair. A variant is compiled (or loaded from the program cache) the
+// first time it's asked for, which SceneRenderer does while loading models, not mid-frame.
+// Uniforms that are the same for every material (camera, light) are set through here. Setting one only
+// stores the value; a variant gets the ones that changed when it's bound with Use(), through uniform
+// locations it looked up once. Variants that aren't drawn this frame cost nothing.
+class ShaderVariants {
+public:
+    ShaderVariants(const char* vertexPath, const char* fragmentPath)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath) {}
+
+    ~ShaderVariants() {
+        for (Variant& variant : variants) {
+            delete variant.shader;
+        }
+    }
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // Compiles the variant if it isn't yet. Bind it with Use, that's what brings its shared uniforms up to date.
+    Shader& Get(const ShaderPermutation& permutation) {
+        return *GetVariant(permutation).shader;
+    }
+
+    // Binds the variant and sets the shared uniforms that changed since it was last bound
+    Shader& Use(const ShaderPermutation& permutation) {
+        Variant& variant = GetVariant(permutation);
+        variant.shader->use();
+        Apply(variant);
+        return *variant.shader;
+    }
+
+    int GetVariantCount() const {
+        int count = 0;
+        for (const Variant& variant : variants) {
+            if (variant.shader) count++;
+        }
+        return count;
+    }
+
+    // Shared uniforms, applied to each variant the next time it's bound
+    void setInt(const std::string& name, int value) {
+        float converted = static_cast<float>(value);
+        SetShared(name, UniformType::Int, &converted, 1, value);
+    }
+    void setFloat(const std::string& name, float value) {
+        SetShared(name, UniformType::Float, &value, 1);
+    }
+    void setVec2(const std::string& name, const glm::vec2& value) {
+        SetShared(name, UniformType::Vec2, &value[0], 2);
+    }
+    void setVec3(const std::string& name, const glm::vec3& value) {
+        SetShared(name, UniformType::Vec3, &value[0], 3);
+    }
+    void setVec3(const std::string& name, float x, float y, float z) {
+        setVec3(name, glm::vec3(x, y, z));
+    }
+    void setMat4(const std::string& name, const glm::mat4& value) {
+        SetShared(name, UniformType::Mat4, &value[0][0], 16);
+    }
+
+private:
+    enum class UniformType : uint8_t { Int, Float, Vec2, Vec3, Mat4 };
+
+    struct SharedUniform {
+        std::string name;
+        UniformType type;
+        int intValue = 0;
+        float values[16];
+        uint32_t version = 0; // Bumped whenever the value changes
+    };
+
+    struct Variant {
+        Shader* shader = nullptr;
+        unsigned int program = 0;      // Shader::ID the locations belong to, a hot reload relinks it
+        std::vector<GLint> locations;  // Per shared uniform, notLookedUp until first needed
+        std::vector<uint32_t> applied; // Per shared uniform, the version the program has
+    };
+
+    enum : GLint { notLookedUp = -2 }; // -1 is GL's "not in this program"
+
+    std::string vertexPath;
+    std::string fragmentPath;
+    Variant variants[ShaderPermutation::keyCount]; // By ShaderPermutation::Key
+    std::vector<SharedUniform> shared; // A handful, found by a linear search
+
+    Variant& GetVariant(const ShaderPermutation& permutation) {
+        Variant& variant = variants[permutation.Key()];
+        if (!variant.shader) {
+            variant.shader = new Shader(vertexPath.c_str(), fragmentPath.c_str(), permutation.Defines());
+        }
+        return variant;
+    }
+
+    void SetShared(const std::string& name, UniformType type, const float* values, int count, int intValue = 0) {
+        SharedUniform* uniform = nullptr;
+        for (SharedUniform& existing : shared) {
+            if (existing.name == name) {
+                uniform = &existing;
+                break;
+            }
+        }
+        if (!uniform) {
+            shared.push_back(SharedUniform());
+            uniform = &shared.back();
+            uniform->name = name;
+        }
+        else if (uniform->type == type && uniform->intValue == intValue &&
+                 std::equal(values, values + count, uniform->values)) {
+            return; // Same as last time, nothing to send
+        }
+
+        uniform->type = type;
+        uniform->intValue = intValue;
+        std::copy(values, values + count, uniform->values);
+        uniform->version++;
+    }
+
+    void Apply(Variant& variant) const {
+        // New or relinked program: look everything up again and send every value
+        if (variant.program != variant.shader->ID) {
+            variant.program = variant.shader->ID;
+            variant.locations.assign(shared.size(), notLookedUp);
+            variant.applied.assign(shared.size(), 0);
+        }
+        variant.locations.resize(shared.size(), notLookedUp);
+        variant.applied.resize(shared.size(), 0);
+
+        for (size_t i = 0; i < shared.size(); i++) {
+            const SharedUniform& uniform = shared[i];
+            if (variant.applied[i] == uniform.version) continue;
+            variant.applied[i] = uniform.version;
+
+            GLint& location = variant.locations[i];
+            if (location == notLookedUp) {
+                location = glGetUniformLocation(variant.program, uniform.name.c_str());
+            }
+            if (location < 0) continue;
+
+            switch (uniform.type) {
+            case UniformType::Int:   glUniform1i(location, uniform.intValue); break;
+            case UniformType::Float: glUniform1f(location, uniform.values[0]); break;
+            case UniformType::Vec2:  glUniform2fv(location, 1, uniform.values); break;
+            case UniformType::Vec3:  glUniform3fv(location, 1, uniform.values); break;
+            case UniformType::Mat4:  glUniformMatrix4fv(location, 1, GL_FALSE, uniform.values); break;
+            }
+        }
+    }
+};
+
+#endif // SHADER_VARIANTS_HPP
@@ -0,0 +1,193 @@
+#ifndef SHADOW_MAP_HPP
+#define SHADOW_MAP_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "ecs.hpp"
+#include "scene_renderer.hpp"
+#include "shader.hpp"
+#include "shader_variants.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Shadow map for the top light, looking straight down from it with a wide perspective frustum.
+// Casters that don't move are kept in a cached depth map: objects marked static (machine, ground) and anything
+// that hasn't moved for a while (prizes resting in the pile, the idle claw). It's only redrawn when that set
+// changes or the light moves. Every frame the cached depth is copied into the frame's map and just the moving
+// casters are drawn on top.
+class ShadowMap {
+public:
+    static const int textureUnit = 11;
+
+    // Frames an object has to stay put before its shadow goes into the cache
+    int settleFrames = 30;
+
+    explicit ShadowMap(int size = 2048) : size(size) {
+        cachedDepth = CreateDepthTexture();
+        frameDepth = CreateDepthTexture();
+        cachedFBO = CreateFramebuffer(cachedDepth);
+        frameFBO = CreateFramebuffer(frameDepth);
+    }
+
+    ~ShadowMap() {
+        glDeleteFramebuffers(1, &cachedFBO);
+        glDeleteFramebuffers(1, &frameFBO);
+        glDeleteTextures(1, &cachedDepth);
+        glDeleteTextures(1, &frameDepth);
+    }
+
+    ShadowMap(const ShadowMap&) = delete;
+    ShadowMap& operator=(const ShadowMap&) = delete;
+
+    // Renders this frame's shadow map. depthShader is the position-only one, its uV/uP are left set to the
+    // light's view. Restores the framebuffer and viewport.
+    void Update(SceneRenderer& renderer, Shader& depthShader, const std::vector<DrawItem>& items, const glm::vec3& lightPosition) {
+        // Straight down, wide enough to cover the machine and the ground around it
+        glm::mat4 lightView = glm::lookAt(lightPosition, lightPosition + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+        glm::mat4 lightProjection = glm::perspective(glm::radians(120.0f), 1.0f, 0.5f, 15.0f);
+        lightSpace = lightProjection * lightView;
+
+        SplitCasters(items);
+
+        // The cache is stale if any cached caster moved or left, a new one settled, or the light moved
+        bool cacheValid = lightPosition == cachedLightPosition && cachedItems.size() == lastCachedItems.size();
+        for (size_t i = 0; cacheValid && i < cachedItems.size(); i++) {
+            cacheValid = SameCaster(cachedItems[i], lastCachedItems[i]);
+        }
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glViewport(0, 0, size, size);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f); // Against shadow acne
+
+        depthShader.use();
+        depthShader.setMat4("uV", lightView);
+        depthShader.setMat4("uP", lightProjection);
+
+        if (!cacheValid) {
+            glBindFramebuffer(GL_FRAMEBUFFER, cachedFBO);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            renderer.DrawDepth(depthShader, cachedItems, false);
+            lastCachedItems = cachedItems;
+            cachedLightPosition = lightPosition;
+            cacheRedraws++;
+        }
+
+        // Cached casters, then the moving ones over them
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, cachedFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frameFBO);
+        glBlitFramebuffer(0, 0, size, size, 0, 0, size, size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, frameFBO);
+        dynamicDrawCalls = renderer.DrawDepth(depthShader, dynamicItems, false);
+
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    // The sampler unit and this frame's light matrix, for the SHADOWS variants
+    void SetUniforms(ShaderVariants& shaders) const {
+        shaders.setInt("uShadowMap", textureUnit);
+        shaders.setMat4("uLightSpace", lightSpace);
+    }
+
+    void Bind() const {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D, frameDepth);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t GetCachedCasterCount() const { return lastCachedItems.size(); }
+    size_t GetDynamicCasterCount() const { return dynamicItems.size(); }
+    int GetDynamicDrawCalls() const { return dynamicDrawCalls; }
+    int GetCacheRedraws() const { return cacheRedraws; } // Since startup
+
+private:
+    struct Tracked {
+        uint32_t generation = 0;
+        glm::mat4 transform = glm::mat4(1.0f);
+        int stillFrames = 0;
+    };
+
+    int size;
+    GLuint cachedDepth = 0, frameDepth = 0;
+    GLuint cachedFBO = 0, frameFBO = 0;
+    glm::mat4 lightSpace = glm::mat4(1.0f);
+    glm::vec3 cachedLightPosition = glm::vec3(-1e9f);
+
+    std::vector<Tracked> tracked; // By entity index
+    std::vector<DrawItem> cachedItems;
+    std::vector<DrawItem> lastCachedItems; // What the cached map was drawn from
+    std::vector<DrawItem> dynamicItems;
+    int dynamicDrawCalls = 0;
+    int cacheRedraws = 0;
+
+    void SplitCasters(const std::vector<DrawItem>& items) {
+        cachedItems.clear();
+        dynamicItems.clear();
+        for (const DrawItem& item : items) {
+            if (item.entity.index >= tracked.size()) {
+                tracked.resize(item.entity.index + 1);
+            }
+            Tracked& object = tracked[item.entity.index];
+            if (object.generation != item.entity.generation || object.transform != item.transform) {
+                object.generation = item.entity.generation;
+                object.transform = item.transform;
+                object.stillFrames = 0;
+            }
+            else if (object.stillFrames < settleFrames) {
+                object.stillFrames++;
+            }
+
+            if (item.isStatic || object.stillFrames >= settleFrames) {
+                cachedItems.push_back(item);
+            }
+            else {
+                dynamicItems.push_back(item);
+            }
+        }
+    }
+
+    static bool SameCaster(const DrawItem& a, const DrawItem& b) {
+        return a.entity == b.entity && a.model == b.model && a.transform == b.transform;
+    }
+
+    GLuint CreateDepthTexture() const {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        // Hardware depth compare with bilinear filtering (2x2 PCF per lookup)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        // Outside the map counts as lit
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        const float border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+
+    static GLuint CreateFramebuffer(GLuint depthTexture) {
+        GLuint framebuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "Warning: shadow map framebuffer is incomplete" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return framebuffer;
+    }
+};
+
+#endif // SHADOW_MAP_HPP
@@ -0,0 +1,92 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+// Mass simulation: many independent claw machines played by bots, stepped in parallel on every core,
+// for tuning prize difficulty and payout rates. No window, no GL.
+//
+//   Simulate [--machines 1000] [--prizes 20] [--seconds 60] [--threads 0] [--seed 1] [--out simulation.json]
+//
+// --threads 0 uses one thread per core. Writes the totals and one line per machine to --out.
+
+#include <reactphysics3d/reactphysics3d.h>
+#include "claw_game.hpp"
+#include "machine_batch.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+const double stepTime = 1.0 / 60.0;
+
+std::string ToJson(const BatchResults& results, size_t threads)
+{
+    std::ostringstream out;
+    out << "{\"machines\": " << results.machines << ", \"threads\": " << threads
+        << ", \"simulated_seconds\": " << results.simulatedSeconds << ", \"wall_seconds\": " << results.wallSeconds
+        << ", \"machine_steps\": " << results.machineSteps
+        << ", \"machine_steps_per_second\": " << (results.wallSeconds > 0.0 ? results.machineSteps / results.wallSeconds : 0.0)
+        << ", \"games_played\": " << results.gamesPlayed << ", \"claw_pickups\": " << results.clawPickups
+        << ", \"payout_rate\": " << results.payoutRate << ", \"min_payout_rate\": " << results.minPayoutRate
+        << ", \"max_payout_rate\": " << results.maxPayoutRate << "}";
+    return out.str();
+}
+
+int main(int argc, char** argv)
+{
+    size_t machineCount = 1000;
+    int prizeCount = 20;
+    double seconds = 60.0;
+    size_t threads = 0;
+    unsigned int seed = 1;
+    std::string outPath = "simulation.json";
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--machines") machineCount = static_cast<size_t>(std::max(1, std::atoi(argv[i + 1])));
+        else if (arg == "--prizes") prizeCount = std::max(0, std::atoi(argv[i + 1]));
+        else if (arg == "--seconds") seconds = std::max(0.0, std::atof(argv[i + 1]));
+        else if (arg == "--threads") threads = static_cast<size_t>(std::max(0, std::atoi(argv[i + 1])));
+        else if (arg == "--seed") seed = static_cast<unsigned int>(std::atoi(argv[i + 1]));
+        else if (arg == "--out") outPath = argv[i + 1];
+    }
+
+    ThreadPool pool(threads);
+
+    ClawGameSettings settings;
+    settings.prizeCount = prizeCount;
+
+    std::cout << "Setting up " << machineCount << " machines with " << prizeCount << " prizes on "
+              << pool.GetThreadCount() << " threads" << std::endl;
+    ClawMachineBatch batch(machineCount, settings, pool, seed);
+
+    // One second of game time per batch step, and a progress line in between
+    int totalSteps = static_cast<int>(seconds / stepTime + 0.5);
+    int stepsPerCall = static_cast<int>(1.0 / stepTime + 0.5);
+    for (int step = 0; step < totalSteps; step += stepsPerCall)
+    {
+        batch.Step(stepTime, std::min(stepsPerCall, totalSteps - step));
+
+        BatchResults progress = batch.Aggregate();
+        std::cout << progress.simulatedSeconds << " s simulated, " << progress.gamesPlayed << " games, payout "
+                  << progress.payoutRate << std::endl;
+    }
+
+    BatchResults results = batch.Aggregate();
+
+    std::ofstream out(outPath);
+    out << "{\n  \"total\": " << ToJson(results, pool.GetThreadCount()) << ",\n  \"machines\": [\n";
+    for (size_t i = 0; i < batch.GetMachineCount(); i++)
+    {
+        MachineResult machine = batch.GetMachineResult(i);
+        out << "    {\"games_played\": " << machine.gamesPlayed << ", \"claw_pickups\": " << machine.clawPickups
+            << ", \"step_seconds\": " << machine.stepSeconds << "}" << (i + 1 < batch.GetMachineCount() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+
+    std::cout << std::endl << "Results (" << outPath << "):" << std::endl << ToJson(results, pool.GetThreadCount()) << std::endl;
+    return 0;
+}
@@ -0,0 +1,194 @@
+#ifndef SYSTEMS_HPP
+#define SYSTEMS_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <reactphysics3d/reactphysics3d.h>
+#include "ecs.hpp"
+#include "transform_math.hpp"
+
+#include <vector>
+
+// Builds local and world matrices from the transform components
+class TransformSystem {
+public:
+    // Composes every dirty local matrix in one SIMD batch, then brings all world matrices up to date
+    static void Update(Scene& scene) {
+        ComponentArray<TransformComponent>& transforms = scene.transforms;
+
+        // Scratch space kept per thread so batching doesn't allocate every step
+        thread_local std::vector<uint32_t> dirty;
+        thread_local std::vector<glm::vec3> positions;
+        thread_local std::vector<glm::quat> rotations;
+        thread_local std::vector<glm::vec3> scales;
+        thread_local std::vector<glm::mat4> matrices;
+        dirty.clear();
+        positions.clear();
+        rotations.clear();
+        scales.clear();
+
+        for (size_t i = 0; i < transforms.Size(); i++) {
+            TransformComponent& transform = transforms[i];
+            if (!transform.localDirty) continue;
+            dirty.push_back(static_cast<uint32_t>(i));
+            positions.push_back(transform.position);
+            rotations.push_back(transform.rotation);
+            scales.push_back(transform.scale);
+        }
+
+        matrices.resize(dirty.size());
+        ComposeTRSBatch(positions.data(), rotations.data(), scales.data(), matrices.data(), dirty.size());
+
+        for (size_t i = 0; i < dirty.size(); i++) {
+            TransformComponent& transform = transforms[dirty[i]];
+            transform.local = matrices[i];
+            transform.localDirty = false;
+        }
+
+        for (size_t i = 0; i < transforms.Size(); i++) {
+            UpdateWorld(scene, transforms[i]);
+        }
+    }
+
+    static const glm::mat4& GetLocal(TransformComponent& transform) {
+        if (transform.localDirty) {
+            transform.local = ComposeTRS(transform.position, transform.rotation, transform.scale);
+            transform.localDirty = false;
+        }
+        return transform.local;
+    }
+
+    // Parent world * local, recomputed only if this transform or one of its parents changed
+    static const glm::mat4& GetWorld(Scene& scene, TransformComponent& transform) {
+        UpdateWorld(scene, transform);
+        return transform.world;
+    }
+
+    // Call after changing position/rotation/scale
+    static void MarkChanged(TransformComponent& transform) {
+        transform.localDirty = true;
+        transform.worldDirty = true;
+    }
+
+private:
+    static void UpdateWorld(Scene& scene, TransformComponent& transform) {
+        TransformComponent* parent = transform.parent.IsValid() ? scene.transforms.Get(transform.parent) : nullptr;
+
+        uint32_t parentVersion = 0;
+        if (parent) {
+            UpdateWorld(scene, *parent);
+            parentVersion = parent->worldVersion;
+        }
+
+        if (!transform.worldDirty && parentVersion == transform.parentVersion) return;
+
+        transform.world = parent ? parent->world * GetLocal(transform) : GetLocal(transform);
+        transform.parentVersion = parentVersion;
+        transform.worldDirty = false;
+        transform.worldVersion++;
+    }
+};
+
+
+// Copies rigid body poses into the transforms of the entities they belong to
+class PhysicsSyncSystem {
+public:
+    // Only dynamic bodies are driven by the simulation, everything else is moved by game code.
+    // Returns how many transforms actually changed.
+    static int Update(Scene& scene) {
+        int synced = 0;
+        for (size_t i = 0; i < scene.bodies.Size(); i++) {
+            PhysicsComponent& body = scene.bodies[i];
+            if (!body.rigidBody || body.rigidBody->getType() != rp3d::BodyType::DYNAMIC) continue;
+
+            TransformComponent* transform = scene.transforms.Get(scene.bodies.EntityAt(i));
+            if (transform && Sync(body, *transform)) {
+                synced++;
+            }
+        }
+        return synced;
+    }
+
+    // Same, but only for the given entities (e.g. the active prizes)
+    static int Update(Scene& scene, const std::vector<Entity>& entities) {
+        int synced = 0;
+        for (Entity entity : entities) {
+            PhysicsComponent* body = scene.bodies.Get(entity);
+            if (!body || !body->rigidBody || body->rigidBody->getType() != rp3d::BodyType::DYNAMIC) continue;
+
+            TransformComponent* transform = scene.transforms.Get(entity);
+            if (transform && Sync(*body, *transform)) {
+                synced++;
+            }
+        }
+        return synced;
+    }
+
+    // Returns false without touching anything when the body is asleep or hasn't moved since the last
+    // sync (unless forced)
+    static bool Sync(PhysicsComponent& body, TransformComponent& transform, bool force = false) {
+        if (!body.rigidBody) return false;
+        if (!force && body.rigidBody->isSleeping()) return false;
+
+        const rp3d::Transform& physicsTransform = body.rigidBody->getTransform();
+        if (!force && body.hasSynced && physicsTransform == body.lastTransform) return false;
+        body.lastTransform = physicsTransform;
+        body.hasSynced = true;
+
+        const rp3d::Vector3& position = physicsTransform.getPosition();
+        const rp3d::Quaternion& rotation = physicsTransform.getOrientation();
+        transform.position = glm::vec3(position.x, position.y, position.z);
+        transform.rotation = glm::quat(rotation.w, rotation.x, rotation.y, rotation.z);
+        TransformSystem::MarkChanged(transform);
+        return true;
+    }
+};
+
+
+// Collects what to draw this frame. Doesn't issue any GL calls, so it can run on the physics thread.
+class RenderSystem {
+public:
+    // Run TransformSystem::Update first so the world matrices are current
+    static void Gather(Scene& scene, std::vector<DrawItem>& out) {
+        for (size_t i = 0; i < scene.renders.Size(); i++) {
+            const RenderComponent& render = scene.renders[i];
+            if (!render.visible || render.model == noModel) continue;
+
+            Entity entity = scene.renders.EntityAt(i);
+            TransformComponent* transform = scene.transforms.Get(entity);
+            if (!transform) continue;
+
+            out.push_back({ render.model, transform->world, render.twoSided, render.occlusionTest, render.isStatic, entity });
+        }
+    }
+};
+
+
+// Collects the lights for this frame in world space. Lights on hidden entities (collected prizes) are off.
+class LightSystem {
+public:
+    // Run TransformSystem::Update first so the world matrices are current
+    static void Gather(Scene& scene, std::vector<LightItem>& out) {
+        for (size_t i = 0; i < scene.lights.Size(); i++) {
+            const LightComponent& light = scene.lights[i];
+            if (!light.enabled || light.intensity <= 0.0f) continue;
+
+            Entity entity = scene.lights.EntityAt(i);
+            const RenderComponent* render = scene.renders.Get(entity);
+            if (render && !render->visible) continue;
+
+            TransformComponent* transform = scene.transforms.Get(entity);
+            if (!transform) continue;
+
+            LightItem item;
+            item.position = glm::vec3(transform->world * glm::vec4(light.offset, 1.0f));
+            item.radius = light.radius;
+            item.color = light.color * light.intensity;
+            item.spotCosine = light.spotCosine;
+            item.direction = glm::normalize(glm::vec3(transform->world * glm::vec4(light.direction, 0.0f)));
+            out.push_back(item);
+        }
+    }
+};
+
+#endif // SYSTEMS_HPP
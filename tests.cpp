@@ -0,0 +1,553 @@
+// Unit tests for the simulation side: containers, transform math, the threading helpers, the settled pile
+// cache and light cluster assignment. No window, no GL.
+//
+//   Tests [name]
+//
+// Runs every test, or just the named one (ctest runs them one by one). Exits with 1 if any check failed.
+
+#include <reactphysics3d/reactphysics3d.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "cluster_grid.hpp"
+#include "ecs.hpp"
+#include "gameobject.hpp"
+#include "object_pool.hpp"
+#include "physics_thread.hpp"
+#include "prize_spawner.hpp"
+#include "thread_pool.hpp"
+#include "transform_math.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cout << "  FAILED line " << __LINE__ << ": " << #condition << std::endl; \
+            failures++; \
+        } \
+    } while (0)
+
+bool NearlyEqual(const glm::mat4& a, const glm::mat4& b, float epsilon = 1e-5f)
+{
+    for (int column = 0; column < 4; column++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            if (std::fabs(a[column][row] - b[column][row]) > epsilon) return false;
+        }
+    }
+    return true;
+}
+
+// ---------------- Containers ----------------
+
+void TestObjectPool()
+{
+    struct Counted {
+        int value;
+        explicit Counted(int value) : value(value) {}
+    };
+    ObjectPool<Counted, 4> pool;
+
+    Handle first = pool.Create(1);
+    Handle second = pool.Create(2);
+    Counted* secondObject = pool.Get(second);
+    CHECK(pool.Count() == 2);
+    CHECK(pool.Get(first)->value == 1);
+    CHECK(secondObject->value == 2);
+
+    // Destroyed handles stop resolving, and the reused slot gets a new generation
+    pool.Destroy(first);
+    CHECK(pool.Get(first) == nullptr);
+    CHECK(pool.Count() == 1);
+    Handle reused = pool.Create(3);
+    CHECK(reused.index == first.index);
+    CHECK(reused.generation != first.generation);
+    CHECK(pool.Get(first) == nullptr);
+    CHECK(pool.Get(reused)->value == 3);
+
+    // Destroying a stale handle again does nothing to the new object
+    pool.Destroy(first);
+    CHECK(pool.Get(reused) != nullptr);
+    CHECK(pool.Count() == 2);
+
+    // Growing past a chunk doesn't move anything
+    std::vector<Handle> more;
+    for (int i = 0; i < 10; i++)
+    {
+        more.push_back(pool.Create(100 + i));
+    }
+    CHECK(pool.Capacity() >= 12);
+    CHECK(pool.Get(second) == secondObject);
+    for (int i = 0; i < 10; i++)
+    {
+        CHECK(pool.Get(more[i])->value == 100 + i);
+    }
+
+    Handle invalid;
+    CHECK(!invalid.IsValid());
+    CHECK(pool.Get(invalid) == nullptr);
+
+    pool.Clear();
+    CHECK(pool.Count() == 0);
+    CHECK(pool.Get(second) == nullptr);
+}
+
+void TestComponentArray()
+{
+    Scene scene;
+    Entity a = scene.CreateEntity();
+    Entity b = scene.CreateEntity();
+    Entity c = scene.CreateEntity();
+
+    ComponentArray<int> values;
+    values.Add(a, 1);
+    values.Add(b, 2);
+    values.Add(c, 3);
+    CHECK(values.Size() == 3);
+
+    // The last component is swapped into the hole and still found by its entity
+    values.Remove(a);
+    CHECK(values.Size() == 2);
+    CHECK(!values.Has(a));
+    CHECK(*values.Get(b) == 2);
+    CHECK(*values.Get(c) == 3);
+    for (size_t i = 0; i < values.Size(); i++)
+    {
+        CHECK(*values.Get(values.EntityAt(i)) == values[i]);
+    }
+
+    // Adding again overwrites instead of adding a second one
+    values.Add(b, 20);
+    CHECK(values.Size() == 2);
+    CHECK(*values.Get(b) == 20);
+
+    // A new entity in a destroyed one's slot doesn't see its components
+    scene.DestroyEntity(c);
+    CHECK(!scene.IsAlive(c));
+    Entity d = scene.CreateEntity();
+    CHECK(d.index == c.index);
+    CHECK(scene.IsAlive(d));
+    CHECK(!values.Has(d));
+}
+
+void TestPrizeLists()
+{
+    Scene scene;
+    std::vector<Entity> prizes;
+    for (int i = 0; i < 6; i++)
+    {
+        prizes.push_back(scene.CreateEntity());
+        scene.AddPrize(prizes.back());
+    }
+    scene.AddPrize(prizes[0]); // Already a prize, ignored
+    CHECK(scene.PrizesIn(PrizeState::Active).size() == 6);
+
+    scene.SetPrizeState(prizes[1], PrizeState::Carried);
+    scene.SetPrizeState(prizes[3], PrizeState::Collected);
+    scene.SetPrizeState(prizes[4], PrizeState::Collected);
+    scene.DestroyEntity(prizes[0]);
+    CHECK(scene.PrizesIn(PrizeState::Active).size() == 2);
+    CHECK(scene.PrizesIn(PrizeState::Carried).size() == 1);
+    CHECK(scene.PrizesIn(PrizeState::Collected).size() == 2);
+
+    // Every list entry is in the right state and knows where it is
+    for (int state = 0; state < static_cast<int>(PrizeState::Count); state++)
+    {
+        const std::vector<Entity>& list = scene.PrizesIn(static_cast<PrizeState>(state));
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            const PrizeComponent* prize = scene.GetPrize(list[i]);
+            CHECK(prize != nullptr);
+            if (!prize) continue;
+            CHECK(static_cast<int>(prize->state) == state);
+            CHECK(prize->listIndex == i);
+        }
+    }
+    CHECK(scene.GetPrize(prizes[0]) == nullptr);
+}
+
+// ---------------- Transform math ----------------
+
+void TestComposeTRS()
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> scale(0.1f, 3.0f);
+
+    // Not a multiple of four, so the SSE path and the leftovers both run
+    const size_t count = 11;
+    std::vector<glm::vec3> positions(count), scales(count);
+    std::vector<glm::quat> rotations(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        positions[i] = glm::vec3(value(random), value(random), value(random));
+        rotations[i] = glm::normalize(glm::quat(value(random), value(random), value(random), value(random)));
+        scales[i] = glm::vec3(scale(random), scale(random), scale(random));
+    }
+
+    std::vector<glm::mat4> batch(count);
+    ComposeTRSBatch(positions.data(), rotations.data(), scales.data(), batch.data(), count);
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::mat4 scalar = ComposeTRS(positions[i], rotations[i], scales[i]);
+        glm::mat4 reference = glm::translate(glm::mat4(1.0f), positions[i]) * glm::mat4_cast(rotations[i]) *
+                              glm::scale(glm::mat4(1.0f), scales[i]);
+        CHECK(NearlyEqual(batch[i], scalar));
+        CHECK(NearlyEqual(scalar, reference));
+    }
+}
+
+// ---------------- Threading ----------------
+
+void TestSpscQueue()
+{
+    // Holds one less than its capacity
+    SpscQueue<int, 4> small;
+    CHECK(small.Push(1));
+    CHECK(small.Push(2));
+    CHECK(small.Push(3));
+    CHECK(!small.Push(4));
+    int item = 0;
+    CHECK(small.Pop(item) && item == 1);
+    CHECK(small.Push(4));
+    CHECK(small.Pop(item) && item == 2);
+    CHECK(small.Pop(item) && item == 3);
+    CHECK(small.Pop(item) && item == 4);
+    CHECK(!small.Pop(item));
+
+    // Across threads everything arrives once and in order
+    const int total = 100000;
+    SpscQueue<int, 64> queue;
+    std::thread producer([&queue]() {
+        for (int i = 0; i < total; i++)
+        {
+            while (!queue.Push(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    bool inOrder = true;
+    while (expected < total)
+    {
+        int value;
+        if (queue.Pop(value))
+        {
+            inOrder = inOrder && value == expected;
+            expected++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    CHECK(inOrder);
+    CHECK(!queue.Pop(item));
+}
+
+void TestSnapshotBuffer()
+{
+    SnapshotBuffer<int> buffer;
+    buffer.BeginWrite() = 1;
+    buffer.Publish();
+    CHECK(buffer.Acquire() == 1);
+    CHECK(buffer.Acquire() == 1); // Nothing new, same snapshot
+
+    buffer.BeginWrite() = 2;
+    buffer.Publish();
+    buffer.BeginWrite() = 3;
+    buffer.Publish();
+    CHECK(buffer.Acquire() == 3); // Only the latest
+
+    // The reader only ever sees whole, newer snapshots and ends on the last one
+    const int total = 100000;
+    SnapshotBuffer<std::vector<int>> snapshots;
+    std::atomic<bool> done(false);
+    std::thread writer([&snapshots, &done]() {
+        for (int i = 1; i <= total; i++)
+        {
+            std::vector<int>& snapshot = snapshots.BeginWrite();
+            snapshot.assign(8, i);
+            snapshots.Publish();
+        }
+        done.store(true, std::memory_order_release);
+    });
+    int last = 0;
+    bool consistent = true;
+    while (true)
+    {
+        bool finished = done.load(std::memory_order_acquire);
+        const std::vector<int>& snapshot = snapshots.Acquire();
+        if (!snapshot.empty())
+        {
+            consistent = consistent && snapshot[0] >= last &&
+                         std::count(snapshot.begin(), snapshot.end(), snapshot[0]) == 8;
+            last = snapshot[0];
+        }
+        if (finished) break;
+    }
+    writer.join();
+    CHECK(consistent);
+    CHECK(last == total);
+}
+
+void TestThreadPool()
+{
+    const size_t threadCounts[] = { 1, 4 };
+    const size_t grainSizes[] = { 1, 7, 1000 };
+    for (size_t threads : threadCounts)
+    {
+        ThreadPool pool(threads);
+        CHECK(pool.GetThreadCount() == threads);
+        for (size_t grainSize : grainSizes)
+        {
+            // Several rounds, the workers go to sleep and wake up in between
+            for (int round = 0; round < 3; round++)
+            {
+                const size_t count = 5000;
+                std::vector<std::atomic<int>> visits(count);
+                for (std::atomic<int>& visit : visits)
+                {
+                    visit.store(0);
+                }
+                pool.ParallelFor(count, [&visits](size_t i) { visits[i]++; }, grainSize);
+
+                bool once = true;
+                for (const std::atomic<int>& visit : visits)
+                {
+                    once = once && visit.load() == 1;
+                }
+                CHECK(once);
+            }
+        }
+        pool.ParallelFor(0, [](size_t) {}); // Nothing to do, returns right away
+    }
+}
+
+// ---------------- Prize pile cache ----------------
+
+// Settles a few prizes on a floor, or restores them from the cache. Returns each prize's position and rotation.
+std::vector<glm::mat4> SpawnPile(const PrizeSpawnSettings& settings)
+{
+    rp3d::PhysicsCommon physicsCommon;
+    rp3d::PhysicsWorld* world = physicsCommon.createPhysicsWorld();
+    std::vector<glm::mat4> transforms;
+    {
+        GameObjectManager objects;
+        GameObject* floor = objects.Create("floor", world, rp3d::BodyType::STATIC);
+        floor->SetPosition(glm::vec3(0.0f, -0.5f, 0.0f));
+        floor->AddBoxCollision(physicsCommon, glm::vec3(2.0f, 0.1f, 2.0f));
+
+        PrizeSpawner spawner(objects, physicsCommon, world);
+        for (GameObject* prize : spawner.Spawn(settings))
+        {
+            transforms.push_back(ComposeTRS(prize->GetPosition(), prize->GetRotation(), glm::vec3(1.0f)));
+        }
+        objects.Clear(); // Before the spawner, it owns the prizes' shapes
+    }
+    physicsCommon.destroyPhysicsWorld(world);
+    return transforms;
+}
+
+void TestPileCache()
+{
+    PrizeSpawnSettings settings;
+    settings.count = 8;
+    settings.mix.push_back({ "birb", glm::vec3(1.0f), glm::vec3(0.1f), 1.0f });
+    settings.cachePath = "test_prize_pile.bin";
+    std::remove(settings.cachePath.c_str());
+
+    // Settled and saved, then restored exactly as saved
+    std::vector<glm::mat4> settled = SpawnPile(settings);
+    std::vector<glm::mat4> restored = SpawnPile(settings);
+    CHECK(settled.size() == 8);
+    CHECK(restored.size() == settled.size());
+    bool same = restored.size() == settled.size();
+    for (size_t i = 0; same && i < settled.size(); i++)
+    {
+        same = NearlyEqual(settled[i], restored[i], 0.0f);
+    }
+    CHECK(same);
+
+    // Resting on the floor, not fallen through it
+    for (const glm::mat4& transform : settled)
+    {
+        CHECK(transform[3].y > -0.5f && transform[3].y < 0.7f);
+    }
+
+    // Different settings don't pick up the old pile
+    PrizeSpawnSettings other = settings;
+    other.seed = 2;
+    std::vector<glm::mat4> resettled = SpawnPile(other);
+    CHECK(resettled.size() == 8);
+    bool differs = false;
+    for (size_t i = 0; i < resettled.size() && i < settled.size(); i++)
+    {
+        differs = differs || !NearlyEqual(settled[i], resettled[i], 1e-4f);
+    }
+    CHECK(differs);
+
+    std::remove(settings.cachePath.c_str());
+}
+
+// Endless mode: piles spawned and despawned over and over reuse the same pool slots, entities and shape
+void TestPrizeChurn()
+{
+    PrizeSpawnSettings settings;
+    settings.count = 6;
+    settings.mix.push_back({ "birb", glm::vec3(1.0f), glm::vec3(0.1f), 1.0f });
+    settings.mix.push_back({ "big birb", glm::vec3(2.0f), glm::vec3(0.1f), 1.0f }); // Same box, same shape
+    settings.cachePath = "test_prize_churn.bin";
+    std::remove(settings.cachePath.c_str());
+
+    rp3d::PhysicsCommon physicsCommon;
+    rp3d::PhysicsWorld* world = physicsCommon.createPhysicsWorld();
+    {
+        GameObjectManager objects;
+        GameObject* floor = objects.Create("floor", world, rp3d::BodyType::STATIC);
+        floor->SetPosition(glm::vec3(0.0f, -0.5f, 0.0f));
+        floor->AddBoxCollision(physicsCommon, glm::vec3(2.0f, 0.1f, 2.0f));
+
+        PrizeSpawner spawner(objects, physicsCommon, world);
+        size_t capacity = 0;
+        bool flat = true;
+        for (int round = 0; round < 20; round++)
+        {
+            std::vector<GameObject*> prizes = spawner.Spawn(settings);
+            CHECK(prizes.size() == 6);
+            CHECK(objects.Count() == 7);
+            CHECK(objects.GetScene().PrizesIn(PrizeState::Active).size() == 6);
+            for (GameObject* prize : prizes)
+            {
+                spawner.Despawn(prize);
+            }
+
+            // The first round sizes the pool, every later one fits in it
+            if (round == 0) capacity = objects.Capacity();
+            flat = flat && objects.Capacity() == capacity && objects.Count() == 1 &&
+                   spawner.GetShapeCount() == 1 && objects.GetScene().ModelCount() == 3;
+        }
+        CHECK(flat);
+        CHECK(objects.GetScene().PrizesIn(PrizeState::Active).empty());
+        CHECK(objects.GetScene().transforms.Size() == 1);
+        CHECK(spawner.WasRestored()); // Only the first round had to settle
+
+        objects.Clear();
+    }
+    physicsCommon.destroyPhysicsWorld(world);
+    std::remove(settings.cachePath.c_str());
+}
+
+// ---------------- Light clusters ----------------
+
+void TestLightClusters()
+{
+    ClusterGrid grid;
+    grid.SetPlanes(0.1f, 100.0f);
+    glm::mat4 view(1.0f); // At the origin looking down -z
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    std::vector<LightItem> lights(3);
+    for (LightItem& light : lights)
+    {
+        light.color = glm::vec3(1.0f);
+        light.spotCosine = -1.0f;
+        light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    }
+    lights[0].position = glm::vec3(0.0f, 0.0f, -10.0f); // Straight ahead, depth 9 to 11
+    lights[0].radius = 1.0f;
+    lights[1].position = glm::vec3(0.0f, 0.0f, 10.0f);  // Behind the camera
+    lights[1].radius = 1.0f;
+    lights[2].position = glm::vec3(0.0f, 0.0f, -0.2f);  // Reaches in front of the near plane
+    lights[2].radius = 0.5f;
+
+    grid.Assign(lights, view, projection);
+    CHECK(grid.GetAssignedLightCount() == 2);
+
+    const std::vector<uint32_t>& ranges = grid.GetClusterRanges();
+    const std::vector<uint32_t>& indices = grid.GetLightIndices();
+    auto contains = [&ranges, &indices](int cluster, uint32_t light) {
+        uint32_t first = ranges[cluster * 2], count = ranges[cluster * 2 + 1];
+        return std::find(indices.begin() + first, indices.begin() + first + count, light) != indices.begin() + first + count;
+    };
+
+    // Slices are logarithmic: depth 10 is two thirds of the way from 0.1 to 100
+    CHECK(contains(ClusterGrid::ClusterIndex(8, 4, 16), 0));
+    CHECK(contains(ClusterGrid::ClusterIndex(7, 4, 15), 0));
+    CHECK(!contains(ClusterGrid::ClusterIndex(0, 0, 16), 0));
+    CHECK(!contains(ClusterGrid::ClusterIndex(8, 4, 20), 0));
+
+    // The one at the near plane covers the whole first slice
+    CHECK(contains(ClusterGrid::ClusterIndex(0, 0, 0), 2));
+    CHECK(contains(ClusterGrid::ClusterIndex(ClusterGrid::tilesX - 1, ClusterGrid::tilesY - 1, 0), 2));
+
+    // Ranges are back to back and cover the whole index list, and nothing points at the culled light
+    uint32_t next = 0;
+    for (int cluster = 0; cluster < ClusterGrid::clusterCount; cluster++)
+    {
+        CHECK(ranges[cluster * 2] == next);
+        next += ranges[cluster * 2 + 1];
+    }
+    CHECK(next == indices.size());
+    CHECK(std::find(indices.begin(), indices.end(), 1u) == indices.end());
+
+    // Assigning again starts from scratch
+    lights.resize(1);
+    grid.Assign(lights, view, projection);
+    CHECK(grid.GetAssignedLightCount() == 1);
+    CHECK(!contains(ClusterGrid::ClusterIndex(0, 0, 0), 2));
+}
+
+struct Test {
+    const char* name;
+    void (*run)();
+};
+
+int main(int argc, char** argv)
+{
+    const Test tests[] = {
+        { "ObjectPool", TestObjectPool },
+        { "ComponentArray", TestComponentArray },
+        { "PrizeLists", TestPrizeLists },
+        { "ComposeTRS", TestComposeTRS },
+        { "SpscQueue", TestSpscQueue },
+        { "SnapshotBuffer", TestSnapshotBuffer },
+        { "ThreadPool", TestThreadPool },
+        { "PileCache", TestPileCache },
+        { "PrizeChurn", TestPrizeChurn },
+        { "LightClusters", TestLightClusters }
+    };
+
+    int run = 0;
+    for (const Test& test : tests)
+    {
+        if (argc > 1 && std::strcmp(argv[1], test.name) != 0) continue;
+
+        int failuresBefore = failures;
+        test.run();
+        std::cout << (failures == failuresBefore ? "ok     " : "FAILED ") << test.name << std::endl;
+        run++;
+    }
+
+    if (run == 0)
+    {
+        std::cout << "No test called " << argv[1] << std::endl;
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
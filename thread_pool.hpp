@@ -0,0 +1,160 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool for ParallelFor. Every worker has its own queue and works from the back of it;
+// when it runs dry it steals from the front of the others' queues. Jobs that take longer than the rest
+// (e.g. a claw machine that's mid-pickup while the others are idle) don't leave the other threads waiting.
+class ThreadPool {
+public:
+    // 0 threads = one per core. The thread calling ParallelFor helps too, so it counts as one of them.
+    explicit ThreadPool(size_t threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        // Queue 0 belongs to the calling thread
+        for (size_t i = 0; i < threadCount; i++) {
+            queues.emplace_back(new Queue());
+        }
+        for (size_t i = 1; i < threadCount; i++) {
+            workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadCount() const { return queues.size(); }
+
+    // Calls body(i) for every i in [0, count) across all threads and returns when all of them are done.
+    // Indices are handed out in chunks of grainSize. Only one ParallelFor at a time.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body, size_t grainSize = 1) {
+        if (count == 0) return;
+        grainSize = std::max<size_t>(1, grainSize);
+
+        size_t chunks = (count + grainSize - 1) / grainSize;
+        std::atomic<size_t> remaining(chunks);
+
+        // Counted before they're queued, so a worker taking one can't see the count go below zero
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queuedTasks += chunks;
+        }
+
+        // Spread the chunks evenly, each queue gets a contiguous range so neighbours stay on one thread
+        size_t perQueue = (chunks + queues.size() - 1) / queues.size();
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            Task task;
+            task.body = &body;
+            task.begin = chunk * grainSize;
+            task.end = std::min(count, task.begin + grainSize);
+            task.remaining = &remaining;
+
+            Queue& queue = *queues[chunk / perQueue];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(task);
+        }
+
+        wake.notify_all();
+
+        // Help out until everything is picked up, then wait for the chunks still running elsewhere
+        Task task;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (TakeTask(0, task)) {
+                Run(task);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    struct Task {
+        const std::function<void(size_t)>* body = nullptr;
+        size_t begin = 0;
+        size_t end = 0;
+        std::atomic<size_t>* remaining = nullptr;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // One per thread
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    size_t queuedTasks = 0; // Tasks in any queue, guarded by sleepMutex
+    bool stopping = false;
+
+    void WorkerLoop(size_t index) {
+        Task task;
+        while (true) {
+            if (TakeTask(index, task)) {
+                Run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || queuedTasks > 0; });
+            if (stopping) return;
+        }
+    }
+
+    // Own queue first (newest task), then steal the oldest task from the others
+    bool TakeTask(size_t index, Task& task) {
+        for (size_t offset = 0; offset < queues.size(); offset++) {
+            Queue& queue = *queues[(index + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+
+            if (offset == 0) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+            else {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+
+            std::lock_guard<std::mutex> sleepLock(sleepMutex);
+            queuedTasks--;
+            return true;
+        }
+        return false;
+    }
+
+    static void Run(const Task& task) {
+        for (size_t i = task.begin; i < task.end; i++) {
+            (*task.body)(i);
+        }
+        task.remaining->fetch_sub(1, std::memory_order_acq_rel);
+    }
+};
+
+#endif // THREAD_POOL_HPP
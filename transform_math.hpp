@@ -0,0 +1,103 @@
+#ifndef TRANSFORM_MATH_HPP
+#define TRANSFORM_MATH_HPP
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_MATH_SSE 1
+#endif
+
+// Builds translate * rotate * scale straight from the components: the rotation columns come from the
+// quaternion, get multiplied by the scale, and the translation goes in the last column.
+// Same result as glm::translate * glm::mat4_cast * glm::scale without the three 4x4 multiplies.
+inline glm::mat4 ComposeTRS(const glm::vec3& t, const glm::quat& q, const glm::vec3& s) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    glm::mat4 m;
+    m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f);
+    m[1] = glm::vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f);
+    m[2] = glm::vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+    m[3] = glm::vec4(t, 1.0f);
+    return m;
+}
+
+// ComposeTRS for a whole array. With SSE2 it does four objects at a time: the inputs are transposed so
+// each register holds one component of four objects, the math runs once for all four, and the columns
+// are transposed back into the four output matrices.
+inline void ComposeTRSBatch(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+                            glm::mat4* out, size_t count) {
+    size_t i = 0;
+
+#ifdef TRANSFORM_MATH_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4) {
+        // glm::quat is stored x, y, z, w
+        __m128 qx = _mm_loadu_ps(&rotations[i + 0].x);
+        __m128 qy = _mm_loadu_ps(&rotations[i + 1].x);
+        __m128 qz = _mm_loadu_ps(&rotations[i + 2].x);
+        __m128 qw = _mm_loadu_ps(&rotations[i + 3].x);
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+        __m128 sx = _mm_setr_ps(scales[i].x, scales[i + 1].x, scales[i + 2].x, scales[i + 3].x);
+        __m128 sy = _mm_setr_ps(scales[i].y, scales[i + 1].y, scales[i + 2].y, scales[i + 3].y);
+        __m128 sz = _mm_setr_ps(scales[i].z, scales[i + 1].z, scales[i + 2].z, scales[i + 3].z);
+
+        __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+        __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+        __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+        __m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+        __m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+        __m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+        __m128 m03 = zero;
+
+        __m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+        __m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+        __m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+        __m128 m13 = zero;
+
+        __m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+        __m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+        __m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+        __m128 m23 = zero;
+
+        __m128 m30 = _mm_setr_ps(positions[i].x, positions[i + 1].x, positions[i + 2].x, positions[i + 3].x);
+        __m128 m31 = _mm_setr_ps(positions[i].y, positions[i + 1].y, positions[i + 2].y, positions[i + 3].y);
+        __m128 m32 = _mm_setr_ps(positions[i].z, positions[i + 1].z, positions[i + 2].z, positions[i + 3].z);
+        __m128 m33 = one;
+
+        // Back to one column per register, per object
+        _MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+        _MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+        _MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+        _MM_TRANSPOSE4_PS(m30, m31, m32, m33);
+
+        __m128 columns[4][4] = {
+            { m00, m10, m20, m30 },
+            { m01, m11, m21, m31 },
+            { m02, m12, m22, m32 },
+            { m03, m13, m23, m33 }
+        };
+        for (int object = 0; object < 4; object++) {
+            for (int column = 0; column < 4; column++) {
+                _mm_storeu_ps(&out[i + object][column][0], columns[object][column]);
+            }
+        }
+    }
+#endif
+
+    // Leftovers (or everything, without SSE)
+    for (; i < count; i++) {
+        out[i] = ComposeTRS(positions[i], rotations[i], scales[i]);
+    }
+}
+
+#endif // TRANSFORM_MATH_HPP
@@ -1,128 +1,283 @@
 #include "ui.hpp"
+#include "stb_image.h" // Implemented in model.hpp
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "stb_truetype.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <string>
 
-// Forward declaration for texture loading function
-unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma = false);
-
-Logo::Logo() : VAO(0), VBO(0), texture(0), uiShader(nullptr), loaded(false),
-               posLeft(0.7f), posBottom(0.7f), posRight(0.95f), posTop(0.9f) {
+// 0-1 to 0-255
+static uint8_t ColorByte(float value) {
+    return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
 }
 
-Logo::~Logo() {
-    Cleanup();
-}
+UIBatch::UIBatch(int atlasSize) : shader("ui.vert", "ui.frag"), atlasSize(atlasSize) {
+    shader.use();
+    shader.setInt("screenTexture", 1);
 
-bool Logo::Initialize(const char* texturePath, const char* textureDirectory) {
-    // Default position: top-right corner
-    return Initialize(texturePath, textureDirectory, 0.7f, 0.7f, 0.95f, 0.9f);
-}
+    // Empty atlas, images are copied in as they're added
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
 
-bool Logo::Initialize(const char* texturePath, const char* textureDirectory, 
-                     float left, float bottom, float right, float top) {
-    // Store position
-    posLeft = left;
-    posBottom = bottom;
-    posRight = right;
-    posTop = top;
-    
-    // Generate and configure VAO and VBO
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    
-    // Create initial vertices
-    UpdateVertices();
-    
-    // Load texture
-    texture = TextureFromFile(texturePath, textureDirectory);
-    loaded = (texture != 0);
-    
-    if (loaded) {
-        std::cout << "Logo texture loaded successfully with ID: " << texture << std::endl;
-    } else {
-        std::cout << "Warning: Failed to load logo texture from " << texturePath << std::endl;
-        return false;
-    }
-
-    // Create UI shader
-    uiShader = new Shader("ui.vert", "ui.frag");
-    
-    return true;
-}
-
-void Logo::SetPosition(float left, float bottom, float right, float top) {
-    posLeft = left;
-    posBottom = bottom;
-    posRight = right;
-    posTop = top;
-    UpdateVertices();
-}
-
-void Logo::UpdateVertices() {
-    // Define quad with current position (NDC coordinates: x, y, u, v)
-    float logoVertices[] = {
-        //  Positions          // TexCoords (flipped on Y axis)
-        posLeft,  posTop,      0.0f, 0.0f, // Top Left
-        posRight, posTop,      1.0f, 0.0f, // Top Right
-        posLeft,  posBottom,   0.0f, 1.0f, // Bottom Left
-        posRight, posBottom,   1.0f, 1.0f  // Bottom Right
-    };
-
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(logoVertices), &logoVertices, GL_STATIC_DRAW);
-    
+
     // Position attribute
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+
     // Texture coordinate attribute
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+
+    // Tint, 0-255 per channel
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (void*)offsetof(Vertex, r));
+
     glBindVertexArray(0);
 }
 
-void Logo::Render() {
-    if (!loaded || !uiShader) {
+UIBatch::~UIBatch() {
+    glDeleteBuffers(1, &VBO);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteTextures(1, &atlas);
+}
+
+int UIBatch::AddImage(const char* path, const char* directory) {
+    std::string filename = std::string(directory) + '/' + path;
+    int width, height, components;
+    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &components, 4);
+    if (!data) {
+        std::cout << "Warning: Failed to load UI image from " << filename << std::endl;
+        return -1;
+    }
+
+    int image = AddPixels(data, width, height);
+    stbi_image_free(data);
+    return image;
+}
+
+int UIBatch::AddPixels(const unsigned char* rgba, int width, int height) {
+    // A pixel of space around every image so linear filtering doesn't pick up the neighbors
+    const int padding = 1;
+    if (shelfX + width + padding > atlasSize) {
+        shelfX = 0;
+        shelfY += shelfHeight;
+        shelfHeight = 0;
+    }
+    if (width + padding > atlasSize || shelfY + height + padding > atlasSize) {
+        std::cout << "Warning: UI atlas is full, can't add a " << width << "x" << height << " image" << std::endl;
+        return -1;
+    }
+
+    int x = shelfX, y = shelfY;
+    shelfX += width + padding;
+    shelfHeight = std::max(shelfHeight, height + padding);
+
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    UIImage image;
+    image.u0 = static_cast<float>(x) / atlasSize;
+    image.v0 = static_cast<float>(y) / atlasSize;
+    image.u1 = static_cast<float>(x + width) / atlasSize;
+    image.v1 = static_cast<float>(y + height) / atlasSize;
+    image.width = width;
+    image.height = height;
+    images.push_back(image);
+    return static_cast<int>(images.size()) - 1;
+}
+
+void UIBatch::Sprite(int image, float left, float bottom, float right, float top, const glm::vec4& color) {
+    if (image < 0 || image >= static_cast<int>(images.size())) {
         return;
     }
+    Sprite(images[image], left, bottom, right, top, color);
+}
+
+void UIBatch::Sprite(const UIImage& region, float left, float bottom, float right, float top, const glm::vec4& color) {
+    uint8_t r = ColorByte(color.x), g = ColorByte(color.y), b = ColorByte(color.z), a = ColorByte(color.w);
+
+    // Two triangles, the image's top row at the top of the quad
+    Vertex topLeft     = { left,  top,    region.u0, region.v0, r, g, b, a };
+    Vertex topRight    = { right, top,    region.u1, region.v0, r, g, b, a };
+    Vertex bottomLeft  = { left,  bottom, region.u0, region.v1, r, g, b, a };
+    Vertex bottomRight = { right, bottom, region.u1, region.v1, r, g, b, a };
+    vertices.push_back(topLeft);
+    vertices.push_back(topRight);
+    vertices.push_back(bottomLeft);
+    vertices.push_back(bottomLeft);
+    vertices.push_back(topRight);
+    vertices.push_back(bottomRight);
+}
+
+int UIBatch::Draw() {
+    if (vertices.empty()) {
+        return 0;
+    }
 
-    // Disable depth test to ensure logo is on top
+    // Orphan last frame's storage instead of waiting for the GPU to be done with it
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    bufferCapacity = std::max(bufferCapacity, vertices.size());
+    glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Disable depth test to ensure the UI is on top
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
     glDisable(GL_DEPTH_TEST);
-    
-    // Use UI shader and set texture
-    uiShader->use();
-    uiShader->setInt("screenTexture", 1);
-    
-    // Bind VAO and texture
-    glBindVertexArray(VAO);
+    glDisable(GL_CULL_FACE);
+
+    shader.use();
     glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    
-    // Draw the quad
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+
     // Reset state
-    glActiveTexture(GL_TEXTURE0);
     glBindVertexArray(0);
-    glEnable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    if (cullFace) glEnable(GL_CULL_FACE);
+
+    int quads = static_cast<int>(vertices.size() / 6);
+    vertices.clear();
+    return quads;
+}
+
+Logo::Logo() : image(-1), posLeft(0.7f), posBottom(0.7f), posRight(0.95f), posTop(0.9f) {
+}
+
+bool Logo::Initialize(UIBatch& batch, const char* texturePath, const char* textureDirectory) {
+    // Default position: top-right corner
+    return Initialize(batch, texturePath, textureDirectory, 0.7f, 0.7f, 0.95f, 0.9f);
+}
+
+bool Logo::Initialize(UIBatch& batch, const char* texturePath, const char* textureDirectory,
+                     float left, float bottom, float right, float top) {
+    SetPosition(left, bottom, right, top);
+    image = batch.AddImage(texturePath, textureDirectory);
+    return IsLoaded();
+}
+
+void Logo::SetPosition(float left, float bottom, float right, float top) {
+    posLeft = left;
+    posBottom = bottom;
+    posRight = right;
+    posTop = top;
 }
 
-void Logo::Cleanup() {
-    if (VAO != 0) {
-        glDeleteVertexArrays(1, &VAO);
-        VAO = 0;
+void Logo::Render(UIBatch& batch) const {
+    if (!IsLoaded()) {
+        return;
     }
-    if (VBO != 0) {
-        glDeleteBuffers(1, &VBO);
-        VBO = 0;
+    batch.Sprite(image, posLeft, posBottom, posRight, posTop);
+}
+
+bool Font::Load(UIBatch& batch, const char* path, float pixelHeight) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    stbtt_fontinfo info;
+    if (data.empty() || !stbtt_InitFont(&info, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0))) {
+        std::cout << "Warning: Failed to load font from " << path << std::endl;
+        return false;
     }
-    if (uiShader != nullptr) {
-        delete uiShader;
-        uiShader = nullptr;
+
+    float scale = stbtt_ScaleForPixelHeight(&info, pixelHeight);
+    int ascent, descent, lineGap;
+    stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+    lineHeight = std::ceil((ascent - descent + lineGap) * scale);
+
+    // Coverage goes into the alpha of white pixels, so the sprite tint is the text color
+    std::vector<unsigned char> rgba;
+    for (int c = firstChar; c <= lastChar; c++) {
+        Glyph& glyph = glyphs[c - firstChar];
+        int advance, leftBearing;
+        stbtt_GetCodepointHMetrics(&info, c, &advance, &leftBearing);
+        glyph.advance = std::round(advance * scale);
+
+        int width = 0, height = 0, xOffset = 0, yOffset = 0;
+        unsigned char* bitmap = stbtt_GetCodepointBitmap(&info, scale, scale, c, &width, &height, &xOffset, &yOffset);
+        if (bitmap && width > 0 && height > 0) {
+            rgba.assign(static_cast<size_t>(width) * height * 4, 255);
+            for (int i = 0; i < width * height; i++) {
+                rgba[i * 4 + 3] = bitmap[i];
+            }
+            glyph.image = batch.AddPixels(rgba.data(), width, height);
+            glyph.xOffset = static_cast<float>(xOffset);
+            glyph.yOffset = static_cast<float>(-yOffset); // stb measures down from the baseline
+        }
+        stbtt_FreeBitmap(bitmap, NULL);
     }
-    loaded = false;
+
+    loaded = true;
+    return true;
 }
 
-// Simple texture loading function that uses the existing model.hpp implementation
-extern unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma);
\ No newline at end of file
+const Font::Glyph* Font::GetGlyph(char c) const {
+    if (c < firstChar || c > lastChar) {
+        return nullptr;
+    }
+    return &glyphs[c - firstChar];
+}
+
+bool TextLayout::Set(const Font& font, UIBatch& batch, const std::string& text) {
+    if (this->font == &font && this->text == text) {
+        return false;
+    }
+    this->font = &font;
+    this->text = text;
+    quads.clear();
+    width = 0.0f;
+
+    float penX = 0.0f, penY = 0.0f;
+    for (char c : text) {
+        if (c == '\n') {
+            penX = 0.0f;
+            penY -= font.GetLineHeight();
+            continue;
+        }
+        const Font::Glyph* glyph = font.GetGlyph(c);
+        if (!glyph) continue;
+
+        if (glyph->image >= 0) {
+            const UIImage& region = batch.GetImage(glyph->image);
+            Quad quad;
+            quad.region = region;
+            quad.left = penX + glyph->xOffset;
+            quad.top = penY + glyph->yOffset;
+            quad.right = quad.left + region.width;
+            quad.bottom = quad.top - region.height;
+            quads.push_back(quad);
+        }
+        penX += glyph->advance;
+        width = std::max(width, penX);
+    }
+    return true;
+}
+
+void TextLayout::Render(UIBatch& batch, const glm::vec2& origin, const glm::vec2& pixelSize, const glm::vec4& color) const {
+    // Whole pixels from the bottom-left corner
+    float x = std::round((origin.x + 1.0f) / pixelSize.x) * pixelSize.x - 1.0f;
+    float y = std::round((origin.y + 1.0f) / pixelSize.y) * pixelSize.y - 1.0f;
+    for (const Quad& quad : quads) {
+        batch.Sprite(quad.region, x + quad.left * pixelSize.x, y + quad.bottom * pixelSize.y,
+                     x + quad.right * pixelSize.x, y + quad.top * pixelSize.y, color);
+    }
+}
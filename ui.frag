@@ -1,8 +1,9 @@
 #version 330 core
 out vec4 FragColor;
 in vec2 TexCoords;
-uniform sampler2D screenTexture;
+in vec4 Color;
+uniform sampler2D screenTexture; // The UI atlas
 
 void main() {
-    FragColor = texture(screenTexture, TexCoords);
+    FragColor = texture(screenTexture, TexCoords) * Color;
 }
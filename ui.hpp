@@ -2,38 +2,147 @@
 #define UI_H
 
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 #include "shader.hpp"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Where an image ended up in the UI atlas, in texture coordinates (v = 0 is the image's top row)
+struct UIImage {
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+    int width = 0, height = 0; // In pixels
+};
+
+// All UI goes through here: images are packed into one RGBA atlas texture when they're added, and every
+// frame the quads queued with Sprite() go into one dynamic vertex buffer and are drawn by Draw() in a
+// single call, with one shader. Quads are in NDC (-1 to 1), drawn in the order they were queued.
+class UIBatch {
+public:
+    explicit UIBatch(int atlasSize = 2048);
+    ~UIBatch();
+
+    UIBatch(const UIBatch&) = delete;
+    UIBatch& operator=(const UIBatch&) = delete;
+
+    // Loads an image into the atlas. Returns its id, or -1 if it couldn't be loaded or doesn't fit.
+    int AddImage(const char* path, const char* directory);
+    // Same from RGBA pixels already in memory, rows top to bottom
+    int AddPixels(const unsigned char* rgba, int width, int height);
+
+    const UIImage& GetImage(int image) const { return images[image]; }
+
+    // Queues a quad showing the image, tinted by color
+    void Sprite(int image, float left, float bottom, float right, float top, const glm::vec4& color = glm::vec4(1.0f));
+    // Queues a quad showing part of an atlas region given in texture coordinates
+    void Sprite(const UIImage& region, float left, float bottom, float right, float top, const glm::vec4& color = glm::vec4(1.0f));
+
+    // Draws everything queued since the last Draw on top of the frame, then empties the queue.
+    // Returns the number of quads.
+    int Draw();
+
+    size_t GetImageCount() const { return images.size(); }
+
+private:
+    struct Vertex {
+        float x, y;
+        float u, v;
+        uint8_t r, g, b, a;
+    };
+
+    Shader shader;
+    GLuint VAO = 0, VBO = 0;
+    GLuint atlas = 0;
+    int atlasSize;
+    size_t bufferCapacity = 0; // Vertices the VBO has room for
+
+    // Shelf packing: images go left to right on the current shelf, a new shelf starts above the tallest one
+    int shelfX = 0, shelfY = 0, shelfHeight = 0;
+
+    std::vector<UIImage> images;
+    std::vector<Vertex> vertices;
+};
+
+// An image drawn at a fixed spot on screen, through a UIBatch
 class Logo {
 public:
     Logo();
-    ~Logo();
-    
-    // Initialize with texture path and directory
-    bool Initialize(const char* texturePath, const char* textureDirectory);
-    
+
+    // Adds the image to the batch's atlas. Default position: top-right corner
+    bool Initialize(UIBatch& batch, const char* texturePath, const char* textureDirectory);
+
     // Initialize with custom position and size (NDC coordinates: -1 to 1)
-    bool Initialize(const char* texturePath, const char* textureDirectory, 
+    bool Initialize(UIBatch& batch, const char* texturePath, const char* textureDirectory,
                    float left, float bottom, float right, float top);
-    
-    void Render();
-    void Cleanup();
-    
+
+    // Queues the quad, drawn with the batch's next Draw
+    void Render(UIBatch& batch) const;
+
     // Set position after initialization (NDC coordinates)
     void SetPosition(float left, float bottom, float right, float top);
-    
-    bool IsLoaded() const { return loaded; }
+
+    bool IsLoaded() const { return image >= 0; }
 
 private:
-    unsigned int VAO, VBO;
-    unsigned int texture;
-    Shader* uiShader;
-    bool loaded;
-    
+    int image; // In the batch's atlas, -1 until loaded
+
     // Store current position for updates
     float posLeft, posBottom, posRight, posTop;
-    
-    void UpdateVertices();
 };
 
-#endif
\ No newline at end of file
+// A TrueType font at one pixel size. The printable ASCII glyphs are rasterized once when it's loaded and
+// go into the UI atlas, text is then just quads through the same UIBatch as the images.
+class Font {
+public:
+    struct Glyph {
+        int image = -1;       // In the batch's atlas, -1 for glyphs with no pixels (space)
+        float xOffset = 0.0f; // From the pen position to the bitmap's left edge, in pixels
+        float yOffset = 0.0f; // From the baseline up to the bitmap's top edge
+        float advance = 0.0f;
+    };
+
+    bool Load(UIBatch& batch, const char* path, float pixelHeight);
+
+    // nullptr for characters outside printable ASCII
+    const Glyph* GetGlyph(char c) const;
+    float GetLineHeight() const { return lineHeight; }
+    bool IsLoaded() const { return loaded; }
+
+private:
+    static const int firstChar = 32;
+    static const int lastChar = 126;
+
+    Glyph glyphs[lastChar - firstChar + 1];
+    float lineHeight = 0.0f;
+    bool loaded = false;
+};
+
+// A string laid out once into glyph quads (in pixels, from the first line's baseline). Set() with the same
+// text does nothing, so text that rarely changes costs no layout work per frame, only the quads.
+class TextLayout {
+public:
+    // Returns true if the text changed and was laid out again
+    bool Set(const Font& font, UIBatch& batch, const std::string& text);
+
+    // Queues the quads with the first baseline starting at origin (NDC). pixelSize is the size of one
+    // framebuffer pixel in NDC (2 / width, 2 / height), the origin is snapped to it so glyphs stay sharp.
+    void Render(UIBatch& batch, const glm::vec2& origin, const glm::vec2& pixelSize,
+                const glm::vec4& color = glm::vec4(1.0f)) const;
+
+    float GetWidth() const { return width; } // Widest line, in pixels
+    const std::string& GetText() const { return text; }
+
+private:
+    struct Quad {
+        UIImage region;
+        float left, bottom, right, top;
+    };
+
+    const Font* font = nullptr;
+    std::string text;
+    std::vector<Quad> quads;
+    float width = 0.0f;
+};
+
+#endif
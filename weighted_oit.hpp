@@ -0,0 +1,129 @@
+#ifndef WEIGHTED_OIT_HPP
+#define WEIGHTED_OIT_HPP
+
+#include <GL/glew.h>
+#include "shader.hpp"
+
+#include <iostream>
+
+// Weighted blended order-independent transparency (McGuire & Bavoil). Blended meshes are drawn once, in any
+// order, into two targets: the weighted sum of their premultiplied colors (revealage, the product of
+// 1 - alpha, in its alpha channel) and the sum of the weights. Composite() then resolves that over the frame.
+// An approximation, but one pass no matter how many layers of glass overlap.
+//
+// GL 3.3 has no per-target blend functions (glBlendFunci is 4.0), so both targets share one
+// glBlendFuncSeparate: RGB adds up in both, alpha multiplies by 1 - alpha, which is exactly the revealage.
+class WeightedOIT {
+public:
+    WeightedOIT() : compositeShader("oit_composite.vert", "oit_composite.frag") {
+        compositeShader.use();
+        compositeShader.setInt("uAccumulation", 0);
+        compositeShader.setInt("uWeights", 1);
+
+        glGenFramebuffers(1, &framebuffer);
+        glGenTextures(1, &accumulation);
+        glGenTextures(1, &weights);
+        glGenRenderbuffers(1, &depth);
+        glGenVertexArrays(1, &emptyVAO); // The fullscreen triangle comes from gl_VertexID, core still wants a VAO
+    }
+
+    ~WeightedOIT() {
+        glDeleteVertexArrays(1, &emptyVAO);
+        glDeleteRenderbuffers(1, &depth);
+        glDeleteTextures(1, &weights);
+        glDeleteTextures(1, &accumulation);
+        glDeleteFramebuffers(1, &framebuffer);
+    }
+
+    WeightedOIT(const WeightedOIT&) = delete;
+    WeightedOIT& operator=(const WeightedOIT&) = delete;
+
+    // After the opaque meshes. Copies their depth over so the glass is still hidden behind them, clears the
+    // sums and sets up the blending; then draw the blended meshes with the WEIGHTED_OIT variants.
+    void Begin(int framebufferWidth, int framebufferHeight) {
+        Resize(framebufferWidth, framebufferHeight);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+        const GLfloat clearAccumulation[] = { 0.0f, 0.0f, 0.0f, 1.0f }; // Revealage starts at fully revealed
+        const GLfloat clearWeights[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+        glClearBufferfv(GL_COLOR, 1, clearWeights);
+
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+    }
+
+    // Back to the default framebuffer, blends the resolved transparency over it. Leaves the usual
+    // GL_SRC_ALPHA/GL_ONE_MINUS_SRC_ALPHA blending and depth writes on.
+    void Composite() {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+        glDisable(GL_DEPTH_TEST);
+        compositeShader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, accumulation);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, weights);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+
+        if (depthTest) {
+            glEnable(GL_DEPTH_TEST);
+        }
+        glDepthMask(GL_TRUE);
+    }
+
+private:
+    Shader compositeShader;
+    GLuint framebuffer = 0;
+    GLuint accumulation = 0; // RGBA16F: weighted color sum, revealage
+    GLuint weights = 0;      // R16F: weight sum
+    GLuint depth = 0;        // Copy of the frame's depth
+    GLuint emptyVAO = 0;
+    int width = 0, height = 0;
+
+    void Resize(int framebufferWidth, int framebufferHeight) {
+        if (framebufferWidth == width && framebufferHeight == height) return;
+        width = framebufferWidth;
+        height = framebufferHeight;
+
+        SetupTarget(accumulation, GL_RGBA16F, GL_RGBA);
+        SetupTarget(weights, GL_R16F, GL_RED);
+        // Same format as GLFW's default depth/stencil buffer, blitting depth needs them to match
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulation, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weights, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+        const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "Warning: transparency framebuffer is incomplete" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void SetupTarget(GLuint texture, GLint internalFormat, GLenum format) const {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+};
+
+#endif // WEIGHTED_OIT_HPP